@@ -0,0 +1,274 @@
+#include "BatchSolver.h"
+#include "Graph.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /// Size at which a worker writes out the trees of its graph so far.
+    constexpr size_t FLUSH_BYTES = 1 << 20;
+
+    /// Writes a block out and keeps only its header line for the next piece.
+    void writeBlock(std::string& block, const size_t headerLength, FILE* output, std::mutex& outputLock)
+    {
+        if (block.size() == headerLength)
+            return;
+        {
+            std::lock_guard guard(outputLock);
+            fwrite(block.data(), 1, block.size(), output);
+        }
+        block.resize(headerLength);
+    }
+
+    void appendNumber(std::string& text, const long long value)
+    {
+        char digits[24];
+        text.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+    }
+}
+
+std::vector<std::string> BatchSolver::ListInputs(const std::string& source)
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+
+    if (fs::is_directory(source)) {
+        for (const fs::directory_entry& file : fs::directory_iterator(source))
+            if (file.is_regular_file() && file.path().extension() == ".in")
+                paths.push_back(file.path().string());
+        std::ranges::sort(paths);
+        return paths;
+    }
+
+    std::ifstream list(source);
+    if (!list)
+        throw std::runtime_error("Can't read '" + source + "'");
+
+    for (std::string line; std::getline(list, line); )
+        if (!line.empty() && line[0] != '#')
+            paths.push_back(line);
+    return paths;
+}
+
+std::vector<Vector<int>> BatchSolver::ReadScenarios(std::istream& input)
+{
+    std::vector<Vector<int>> scenarios;
+
+    for (std::string line; std::getline(input, line); ) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        Vector<int> weights;
+        for (int w; ss >> w; )
+            weights.PushBack(w);
+        if (!ss.eof())
+            throw std::runtime_error("Malformed weight vector: " + line);
+        scenarios.push_back(std::move(weights));
+    }
+
+    return scenarios;
+}
+
+BatchSolver::Summary
+BatchSolver::Run(const std::vector<std::string>& paths, FILE* output, const Options& options)
+{
+    Summary summary;
+    summary.threads = WorkStealingPool::Threads(options.threads, paths.size());
+
+    // The searches run side by side, nothing of them may be shared.
+    SolveOptions solveOptions = options.solve;
+    solveOptions.checkpointPath.clear();
+    solveOptions.resumePath.clear();
+    solveOptions.stats = nullptr;
+    solveOptions.perf = nullptr;
+
+    std::mutex outputLock;
+    std::atomic<size_t> graphs = 0, failed = 0, trees = 0;
+
+    // Kept by every worker from one graph to the next.
+    std::vector<std::unique_ptr<SolveState>> states(summary.threads);
+    std::vector<std::string> blocks(summary.threads);
+
+    auto work = [&](const size_t worker, const size_t item) {
+        TraceScope span("graph");
+
+        std::unique_ptr<SolveState>& state = states[worker];
+        std::string& block = blocks[worker];
+
+        block.clear();
+        block += "# file ";
+        block += paths[item];
+        block += '\n';
+        const size_t headerLength = block.size();
+        size_t found = 0;
+
+        try {
+            const Graph graph = SpanningTreesFinder::ReadGraph(paths[item]);
+            if (!graph.VertexCount() || !graph.EdgeCount())
+                throw std::runtime_error("Cannot solve for a tree with no vertices or edges");
+
+            if (state)
+                state->Reset(graph);
+            else
+                state = std::make_unique<SolveState>(graph, solveOptions);
+
+            block += "# kthmst ";
+            appendNumber(block, graph.VertexCount());
+            block += ' ';
+            appendNumber(block, graph.EdgeCount());
+            block += '\n';
+
+            SpanningTreesFinder::Solve(graph, *state, [&](const Partition& p) {
+                appendNumber(block, p.mstCost);
+                block += ':';
+                for (const int e : p.mstEdges) {
+                    block += ' ';
+                    appendNumber(block, e);
+                }
+                block += '\n';
+                if (block.size() >= FLUSH_BYTES)
+                    writeBlock(block, headerLength, output, outputLock);
+                found++;
+                return true;
+            }, solveOptions);
+
+            graphs++;
+            trees += found;
+        } catch (const std::exception& e) {
+            block.resize(headerLength);
+            block += "# error ";
+            block += e.what();
+            block += '\n';
+            failed++;
+        }
+
+        writeBlock(block, headerLength, output, outputLock);
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    WorkStealingPool::Run(paths.size(), summary.threads, work);
+    fflush(output);
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.graphs = graphs;
+    summary.failed = failed;
+    summary.trees = trees;
+    return summary;
+}
+
+BatchSolver::Summary
+BatchSolver::RunScenarios(
+    const Topology& topology,
+    const std::vector<Vector<int>>& scenarios,
+    FILE* output,
+    const Options& options)
+{
+    Summary summary;
+    summary.threads = WorkStealingPool::Threads(options.threads, scenarios.size());
+
+    SolveOptions solveOptions = options.solve;
+    solveOptions.checkpointPath.clear();
+    solveOptions.resumePath.clear();
+    solveOptions.stats = nullptr;
+    solveOptions.perf = nullptr;
+
+    std::mutex outputLock;
+    std::atomic<size_t> graphs = 0, failed = 0, trees = 0;
+
+    // Kept by every worker from one scenario to the next.
+    struct Buffers
+    {
+        std::unique_ptr<SolveState> state;
+        std::string block;
+        Vector<int> order;    ///< Matrix index of every edge of the weighted graph.
+        Vector<int> mapped;   ///< Edges of a tree in the matrix order.
+    };
+    std::vector<Buffers> buffers(summary.threads);
+
+    auto work = [&](const size_t worker, const size_t item) {
+        TraceScope span("scenario");
+
+        Buffers& b = buffers[worker];
+        b.block.clear();
+        b.block += "# scenario ";
+        appendNumber(b.block, item);
+        b.block += '\n';
+        const size_t headerLength = b.block.size();
+        size_t found = 0;
+
+        try {
+            const Graph graph = topology.Weigh(scenarios[item], b.order);
+
+            if (b.state)
+                b.state->Reset(graph);
+            else
+                b.state = std::make_unique<SolveState>(graph, solveOptions);
+
+            // The first space has the bridges included already.
+            Partition* root = b.state->CreatePartition(
+                topology.InitialChoices(b.order), graph, graph.EdgeCount(), nullptr);
+            if (root == nullptr)
+                throw std::runtime_error("The graph is not connected. Spanning tree not possible.");
+            b.state->partitions.Insert(root);
+            b.state->started = true;
+
+            b.block += "# kthmst ";
+            appendNumber(b.block, graph.VertexCount());
+            b.block += ' ';
+            appendNumber(b.block, graph.EdgeCount());
+            b.block += '\n';
+
+            SpanningTreesFinder::Solve(graph, *b.state, [&](const Partition& p) {
+                b.mapped.Clear();
+                for (const int e : p.mstEdges)
+                    b.mapped.PushBack(b.order[e]);
+                std::ranges::sort(b.mapped);
+
+                appendNumber(b.block, p.mstCost);
+                b.block += ':';
+                for (const int e : b.mapped) {
+                    b.block += ' ';
+                    appendNumber(b.block, e);
+                }
+                b.block += '\n';
+                if (b.block.size() >= FLUSH_BYTES)
+                    writeBlock(b.block, headerLength, output, outputLock);
+                found++;
+                return true;
+            }, solveOptions);
+
+            graphs++;
+            trees += found;
+        } catch (const std::exception& e) {
+            b.block.resize(headerLength);
+            b.block += "# error ";
+            b.block += e.what();
+            b.block += '\n';
+            failed++;
+        }
+
+        writeBlock(b.block, headerLength, output, outputLock);
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    WorkStealingPool::Run(scenarios.size(), summary.threads, work);
+    fflush(output);
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.graphs = graphs;
+    summary.failed = failed;
+    summary.trees = trees;
+    return summary;
+}
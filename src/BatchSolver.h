@@ -0,0 +1,82 @@
+#ifndef __BATCH_SOLVER_H
+#define __BATCH_SOLVER_H
+
+#include "SpanningTreesFinder.h"
+#include "Topology.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <istream>
+#include <string>
+#include <vector>
+
+/// @brief Solves many graphs in one process on a work-stealing pool of threads.
+///
+/// The graphs are spread over a WorkStealingPool. A worker keeps its
+/// SolveState and its output buffer from one graph to the next. The trees
+/// of a graph are formatted into the buffer and written to the combined
+/// stream whenever it passes 1 MiB, and once more when the graph is done.
+/// Every piece is a block starting with `# file <path>`, so the trees of a
+/// graph can be told apart even when the pieces of graphs interleave. The
+/// first block of a graph has the text result format header, a failed
+/// graph ends with a block of `# error <message>`.
+class BatchSolver
+{
+public:
+    /// @brief Tuning of a batch.
+    struct Options
+    {
+        size_t threads = 0;  ///< Workers, 0 picks the hardware concurrency.
+        SolveOptions solve;  ///< Options of every search, checkpoints aren't supported.
+    };
+
+    /// @brief What a batch did.
+    struct Summary
+    {
+        size_t graphs = 0;  ///< Graphs solved.
+        size_t failed = 0;  ///< Graphs that couldn't be solved.
+        size_t trees = 0;   ///< Trees written.
+        size_t threads = 0; ///< Workers used.
+        double seconds = 0; ///< Wall time of the batch.
+    };
+
+    /// @brief Lists the input files of a batch.
+    /// @param source A directory (its `.in` files, sorted by name) or a file listing one path per line.
+    /// @return The paths of the input files.
+    /// @throws std::runtime_error if the source can't be read.
+    [[nodiscard]]
+    static std::vector<std::string> ListInputs(const std::string& source);
+
+    /// @brief Reads weight vectors, one per line, lines starting with `#` are skipped.
+    /// @param input The stream to read from.
+    /// @return The weight vectors, their lengths aren't checked here.
+    [[nodiscard]]
+    static std::vector<Vector<int>> ReadScenarios(std::istream& input);
+
+    /// @brief Solves every graph, writing the results to the output.
+    /// @param paths The input files.
+    /// @param output The combined result stream.
+    /// @param options Tuning of the batch.
+    /// @return What the batch did.
+    static Summary Run(const std::vector<std::string>& paths, FILE* output, const Options& options);
+
+    /// @brief Solves one topology under many weight vectors, writing the results to the output.
+    ///
+    /// The blocks of a scenario start with `# scenario <i>`. Its trees
+    /// list their edges in the matrix order of the topology, so trees of
+    /// different scenarios can be compared directly.
+    /// @param topology The graph without its weights.
+    /// @param scenarios Weight vectors of the topology.
+    /// @param output The combined result stream.
+    /// @param options Tuning of the batch.
+    /// @return What the batch did, every scenario counts as a graph.
+    static Summary RunScenarios(
+        const Topology& topology,
+        const std::vector<Vector<int>>& scenarios,
+        FILE* output,
+        const Options& options
+    );
+};
+
+#endif // __BATCH_SOLVER_H
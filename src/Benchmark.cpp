@@ -0,0 +1,128 @@
+#include "Benchmark.h"
+#include "Graph.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+
+std::vector<Benchmark::Case> Benchmark::DefaultSuite(uint64_t seed, size_t k)
+{
+    // Sizes where the first trees come quickly but k is far from all of them.
+    return {
+        { GraphGenerator::COMPLETE,      16,  seed, k },
+        { GraphGenerator::GRID,          8,   seed, k },
+        { GraphGenerator::SPARSE_RANDOM, 60,  seed, k },
+        { GraphGenerator::EQUAL_WEIGHTS, 12,  seed, k },
+        { GraphGenerator::NEAR_TREE,     200, seed, k },
+    };
+}
+
+/// Resets the peak resident set size of the process, Linux only.
+static void resetPeakRss()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+/// Reads the peak resident set size of the process in KiB, 0 if unknown.
+static size_t peakRss()
+{
+    std::ifstream status("/proc/self/status");
+    for (std::string key; status >> key; ) {
+        if (key == "VmHWM:") {
+            size_t kb = 0;
+            status >> kb;
+            return kb;
+        }
+        status.ignore(4096, '\n');
+    }
+    return 0;
+}
+
+Benchmark::Result Benchmark::Run(const Case& bench, SolveOptions options, bool countPerf)
+{
+    using Clock = std::chrono::steady_clock;
+
+    Result result;
+    result.bench = bench;
+
+    std::unique_ptr<PerfCounters> perf;
+    if (countPerf)
+        perf = std::make_unique<PerfCounters>();
+    options.perf = perf.get();
+
+    const Matrix<int> adjMat = GraphGenerator::Generate(bench.family, bench.size, bench.seed);
+
+    Graph graph;
+    {
+        PerfScope graphBuild(perf.get(), PerfReport::GRAPH_BUILD);
+        graph = Graph(adjMat);
+    }
+    result.vertexCount = graph.VertexCount();
+    result.edgeCount = graph.EdgeCount();
+
+    SolveStats stats;
+    options.stats = &stats;
+
+    resetPeakRss();
+    const auto start = Clock::now();
+    auto last = start;
+
+    result.exhausted = true;
+    SpanningTreesFinder::Solve(graph, [&](const Partition&) {
+        last = Clock::now();
+        if (result.trees++ == 0)
+            result.timeToFirst = std::chrono::duration<double>(last - start).count();
+        if (bench.k && result.trees >= bench.k) {
+            result.exhausted = false;
+            return false;
+        }
+        return true;
+    }, options);
+
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.timeToK = std::chrono::duration<double>(last - start).count();
+    result.peakRss = peakRss();
+    result.frontierHighWater = stats.frontierHighWater;
+
+    if (perf) {
+        result.perfCounted = true;
+        result.perf = perf->Report();
+    }
+
+    return result;
+}
+
+void Benchmark::WriteJson(std::ostream& os, const std::vector<Result>& results)
+{
+    os << "{\n  \"cases\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << (i ? ",\n" : "\n")
+           << "    {\n"
+           << "      \"family\": \"" << GraphGenerator::FamilyName(r.bench.family) << "\",\n"
+           << "      \"size\": " << r.bench.size << ",\n"
+           << "      \"seed\": " << r.bench.seed << ",\n"
+           << "      \"k\": " << r.bench.k << ",\n"
+           << "      \"vertices\": " << r.vertexCount << ",\n"
+           << "      \"edges\": " << r.edgeCount << ",\n"
+           << "      \"trees\": " << r.trees << ",\n"
+           << "      \"exhausted\": " << (r.exhausted ? "true" : "false") << ",\n"
+           << "      \"seconds\": " << r.seconds << ",\n"
+           << "      \"trees_per_second\": " << (r.seconds > 0 ? r.trees / r.seconds : 0) << ",\n"
+           << "      \"time_to_first_ms\": " << r.timeToFirst * 1e3 << ",\n"
+           << "      \"time_to_k_ms\": " << r.timeToK * 1e3 << ",\n"
+           << "      \"peak_rss_kb\": " << r.peakRss << ",\n"
+           << "      \"frontier_high_water\": " << r.frontierHighWater;
+
+        if (r.perfCounted) {
+            os << ",\n      \"perf\": ";
+            r.perf.WriteJson(os, 6);
+        }
+
+        os << "\n    }";
+    }
+
+    os << "\n  ]\n}\n";
+}
@@ -0,0 +1,63 @@
+#ifndef __BENCHMARK_H
+#define __BENCHMARK_H
+
+#include "GraphGenerator.h"
+#include "PerfCounters.h"
+#include "SpanningTreesFinder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/// @brief Measures the end-to-end throughput of SpanningTreesFinder::Solve.
+///
+/// Every case generates a graph with GraphGenerator and enumerates its
+/// first `k` trees (or all of them if there are fewer), without any output.
+class Benchmark
+{
+public:
+    /// @brief A single measured enumeration.
+    struct Case
+    {
+        GraphGenerator::Family family;
+        size_t size;   ///< Vertices, or the side of the grid.
+        uint64_t seed; ///< Seed of the generated graph.
+        size_t k;      ///< Trees to enumerate, 0 for all of them.
+    };
+
+    /// @brief What was measured for a case.
+    struct Result
+    {
+        Case bench;
+        size_t vertexCount = 0;
+        size_t edgeCount = 0;
+        size_t trees = 0;            ///< Trees enumerated.
+        bool exhausted = false;      ///< All trees of the graph were enumerated.
+        double seconds = 0;          ///< Time of the whole enumeration.
+        double timeToFirst = 0;      ///< Seconds until the MST came out.
+        double timeToK = 0;          ///< Seconds until the last tree came out.
+        size_t peakRss = 0;          ///< Peak resident set size in KiB, 0 if unknown.
+        size_t frontierHighWater = 0; ///< Most partitions waiting at once.
+        bool perfCounted = false;     ///< Hardware counters were requested.
+        PerfReport perf;              ///< Hardware counters per phase, generation counts as parsing.
+    };
+
+    /// @brief Builds the default suite, one case per family.
+    /// @param seed Seed of all the graphs.
+    /// @param k Trees to enumerate per case.
+    [[nodiscard]]
+    static std::vector<Case> DefaultSuite(uint64_t seed, size_t k);
+
+    /// @brief Runs a single case.
+    /// @param bench The case to run.
+    /// @param options Options of the search, the stats are collected by the benchmark.
+    /// @param countPerf Also count hardware events per phase.
+    [[nodiscard]]
+    static Result Run(const Case& bench, SolveOptions options = SolveOptions(), bool countPerf = false);
+
+    /// @brief Writes the results as a JSON document.
+    static void WriteJson(std::ostream& os, const std::vector<Result>& results);
+};
+
+#endif // __BENCHMARK_H
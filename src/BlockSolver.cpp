@@ -0,0 +1,274 @@
+#include "BlockSolver.h"
+#include "Edge.h"
+#include "Partition.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <utility>
+
+namespace
+{
+    /// A combination of block trees waiting in the merge heap.
+    struct Combination
+    {
+        int cost;
+        int pivot;    ///< Block changed last, -1 for the cheapest tree.
+        size_t slot;  ///< Where its tree index per block is kept.
+    };
+
+    struct CombinationGreater
+    {
+        bool operator()(const Combination& l, const Combination& r) const { return l.cost > r.cost; }
+    };
+}
+
+BlockSolver::BlockSolver(const Graph& g)
+: graph(g)
+{
+    if (!g.VertexCount() || !g.EdgeCount())
+        throw std::runtime_error("Cannot solve for a tree with no vertices or edges");
+
+    decompose();
+}
+
+size_t BlockSolver::LargestBlock() const
+{
+    size_t largest = bridges.Empty() ? 0 : 1;
+    for (const Block& b : blocks)
+        largest = std::max(largest, b.edges.Size());
+    return largest;
+}
+
+void BlockSolver::decompose()
+{
+    TraceScope span("blocks");
+
+    const Vector<Edge>& edges = graph.Edges();
+    const size_t vertexCount = graph.VertexCount();
+
+    std::vector<std::vector<std::pair<int, int>>> adjacent(vertexCount);
+    for (size_t i = 0; i < edges.Size(); ++i) {
+        adjacent[edges[i].nodeX].emplace_back(edges[i].nodeY, i);
+        adjacent[edges[i].nodeY].emplace_back(edges[i].nodeX, i);
+    }
+
+    std::vector<int> discovered(vertexCount, -1), low(vertexCount, 0), local(vertexCount, -1);
+    int time = 0;
+
+    // Edges seen but not yet assigned to a block, a block is on top once its root is done.
+    std::vector<int> pending;
+
+    auto split = [&](const int last) {
+        Vector<int> blockEdges;
+        int e;
+        do {
+            e = pending.back();
+            pending.pop_back();
+            blockEdges.PushBack(e);
+        } while (e != last);
+
+        if (blockEdges.Size() == 1) {
+            bridges.PushBack(e);
+            bridgeCost += edges[e].weight;
+            return;
+        }
+
+        // The graph's edges are sorted by weight, so are the block's in the order of their indices.
+        std::ranges::sort(blockEdges);
+
+        Vector<Edge> renumbered;
+        int vertices = 0;
+        for (const int i : blockEdges) {
+            int& x = local[edges[i].nodeX];
+            int& y = local[edges[i].nodeY];
+            if (x < 0)
+                x = vertices++;
+            if (y < 0)
+                y = vertices++;
+            renumbered.EmplaceBack(x, y, edges[i].weight);
+        }
+        for (const int i : blockEdges)
+            local[edges[i].nodeX] = local[edges[i].nodeY] = -1;
+
+        blocks.push_back(Block{ Graph(vertices, renumbered), std::move(blockEdges), nullptr, false, {}, {} });
+    };
+
+    // (vertex, edge it was reached by, next adjacency to look at)
+    std::vector<std::tuple<int, int, size_t>> stack;
+
+    discovered[0] = low[0] = time++;
+    stack.emplace_back(0, -1, 0);
+
+    while (!stack.empty()) {
+        auto& [v, via, next] = stack.back();
+
+        if (next < adjacent[v].size()) {
+            const auto [u, e] = adjacent[v][next++];
+            if (e == via)
+                continue;
+            if (discovered[u] < 0) {
+                pending.push_back(e);
+                discovered[u] = low[u] = time++;
+                stack.emplace_back(u, e, 0);
+            } else if (discovered[u] < discovered[v]) {
+                // A back edge, seen once from its lower end.
+                pending.push_back(e);
+                low[v] = std::min(low[v], discovered[u]);
+            }
+            continue;
+        }
+
+        // All of v is explored, pass its low link up to the parent.
+        const int vertex = v, edge = via;
+        stack.pop_back();
+        if (edge < 0)
+            continue;
+
+        const int parent = edges[edge].nodeX == vertex ? edges[edge].nodeY : edges[edge].nodeX;
+        low[parent] = std::min(low[parent], low[vertex]);
+        if (low[vertex] >= discovered[parent])
+            split(edge);
+    }
+
+    if (std::ranges::any_of(discovered, [](const int d) { return d < 0; }))
+        throw std::runtime_error("The graph is not connected. Spanning tree not possible.");
+}
+
+bool BlockSolver::fetch(Block& block, const size_t i, const SolveOptions& options)
+{
+    if (i < block.costs.Size())
+        return true;
+    if (block.complete)
+        return false;
+
+    if (!block.state)
+        block.state = std::make_unique<SolveState>(block.graph, options);
+
+    auto collect = [&block](const Partition& p) {
+        block.costs.PushBack(p.mstCost);
+        for (const int e : p.mstEdges)
+            block.trees.PushBack(block.edges[e]);
+        return true;
+    };
+
+    // Asking for more than needed keeps the number of calls logarithmic.
+    while (i >= block.costs.Size() && !block.state->Finished()) {
+        SolveOptions blockOptions = options;
+        blockOptions.treeLimit = block.state->emitted + std::max<size_t>(block.costs.Size(), 64);
+        SpanningTreesFinder::Solve(block.graph, *block.state, collect, blockOptions);
+    }
+
+    // A finished search isn't needed anymore, all its trees are kept.
+    if (block.state->Finished()) {
+        block.state.reset();
+        block.complete = true;
+    }
+
+    return i < block.costs.Size();
+}
+
+void BlockSolver::Solve(const SpanningTreesFinder::TreeCallback& onTree, const SolveOptions& options)
+{
+    if (!options.checkpointPath.empty() || !options.resumePath.empty())
+        throw std::runtime_error("Checkpoints can't be combined with the block decomposition");
+
+    SolveOptions blockOptions = options;
+    blockOptions.treeLimit = 0;
+    blockOptions.stop = nullptr;
+    blockOptions.stats = nullptr;
+
+    // A block has a cycle, so at least three trees.
+    for (Block& b : blocks)
+        fetch(b, 1, blockOptions);
+
+    std::ranges::stable_sort(blocks, [](const Block& l, const Block& r) {
+        return l.costs[1] - l.costs[0] < r.costs[1] - r.costs[0];
+    });
+
+    const size_t m = blocks.size();
+    auto gap = [this](const size_t j) { return blocks[j].costs[1] - blocks[j].costs[0]; };
+
+    // Tree index per block of every combination in the heap, freed slots are reused.
+    std::vector<int> indices;
+    std::vector<size_t> freeSlots;
+    auto allocate = [&](const size_t from) {
+        size_t slot;
+        if (freeSlots.empty()) {
+            slot = indices.size() / std::max<size_t>(m, 1);
+            indices.resize(indices.size() + std::max<size_t>(m, 1));
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        std::copy_n(indices.begin() + from * m, m, indices.begin() + slot * m);
+        return slot;
+    };
+
+    // Polled once per tree and pushed up to three times, BinaryHeap::Poll rebuilds the whole heap.
+    std::priority_queue<Combination, std::vector<Combination>, CombinationGreater> heap;
+    int cheapest = bridgeCost;
+    for (const Block& b : blocks)
+        cheapest += b.costs[0];
+    indices.assign(std::max<size_t>(m, 1), 0);
+    heap.push({ cheapest, -1, 0 });
+
+    size_t emitted = 0;
+    Vector<int> treeEdges(graph.VertexCount() - 1);
+
+    while (!heap.empty()) {
+        if (options.treeLimit && emitted >= options.treeLimit)
+            return;
+        if (options.stop && *options.stop)
+            return;
+
+        const Combination c = heap.top();
+        heap.pop();
+        const int* index = indices.data() + c.slot * m;
+
+        treeEdges.Clear();
+        for (const int e : bridges)
+            treeEdges.PushBack(e);
+        for (size_t j = 0; j < m; ++j) {
+            const size_t width = blocks[j].graph.VertexCount() - 1;
+            const int* tree = blocks[j].trees.begin() + index[j] * width;
+            for (size_t k = 0; k < width; ++k)
+                treeEdges.PushBack(tree[k]);
+        }
+        std::ranges::sort(treeEdges);
+
+        if (!onTree(Partition(Partition::Choices(), c.cost, treeEdges)))
+            return;
+        emitted++;
+
+        const int p = c.pivot;
+        const int at = p >= 0 ? index[p] : 0;
+
+        // The next tree of the same block.
+        if (p >= 0 && fetch(blocks[p], at + 1, blockOptions)) {
+            const size_t slot = allocate(c.slot);
+            indices[slot * m + p] = at + 1;
+            heap.push({ c.cost + blocks[p].costs[at + 1] - blocks[p].costs[at], p, slot });
+        }
+
+        if ((size_t)(p + 1) < m) {
+            // The second tree of the next block on top.
+            size_t slot = allocate(c.slot);
+            indices[slot * m + p + 1] = 1;
+            heap.push({ c.cost + gap(p + 1), p + 1, slot });
+
+            // The change moved over to the next block.
+            if (p >= 0 && at == 1) {
+                slot = allocate(c.slot);
+                indices[slot * m + p] = 0;
+                indices[slot * m + p + 1] = 1;
+                heap.push({ c.cost + gap(p + 1) - gap(p), p + 1, slot });
+            }
+        }
+
+        freeSlots.push_back(c.slot);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef __BLOCK_SOLVER_H
+#define __BLOCK_SOLVER_H
+
+#include "Graph.h"
+#include "SpanningTreesFinder.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/// @brief Enumerates the spanning trees of a graph block by block.
+///
+/// A spanning tree of a connected graph is exactly one spanning tree of
+/// every biconnected block put together, so the trees are the Cartesian
+/// product of the trees of the blocks and its cost is the sum of theirs.
+/// The blocks are found with Tarjan's algorithm. A block of a single edge
+/// (a bridge) is in every tree, every other block gets a search of its own,
+/// which is advanced only as far as the merge asks for.
+///
+/// The merge is a k-best-sums heap over the product. A combination is an
+/// index into the sorted trees of every block, it's reached from exactly
+/// one cheaper combination by raising the index of its last changed block,
+/// by changing the next block, or by moving the change over to the next
+/// block. The blocks are ordered by the gap between their two best trees,
+/// which keeps every step non-decreasing in cost. A combination thus has at
+/// most three successors and the trees come out in non-decreasing order.
+class BlockSolver
+{
+public:
+    /// @brief Splits the graph into its biconnected blocks.
+    /// @param g The graph, it must outlive the solver.
+    /// @throws std::runtime_error if the graph has no edges or isn't connected.
+    explicit BlockSolver(const Graph& g);
+
+    BlockSolver(const BlockSolver&) = delete;
+    BlockSolver& operator=(const BlockSolver&) = delete;
+
+    [[nodiscard]] size_t BlockCount() const { return blocks.size(); }    ///< Blocks searched, bridges aside.
+    [[nodiscard]] size_t BridgeCount() const { return bridges.Size(); }  ///< Edges in every tree.
+    [[nodiscard]] size_t LargestBlock() const;                            ///< Edges of the largest block.
+
+    /// @brief Streams the spanning trees of the graph to a callback.
+    ///
+    /// Trees have the same cost and edges as the trees of SpanningTreesFinder::Solve,
+    /// only equal trees may come in another order. They have no choices and no parent.
+    /// @param onTree Callback receiving every tree, returns `false` to stop.
+    /// @param options Options of the block searches, SolveOptions::treeLimit counts
+    ///                the trees of the graph. Checkpoints aren't supported, the
+    ///                statistics aren't collected.
+    /// @throws std::runtime_error if a checkpoint is asked for.
+    void Solve(const SpanningTreesFinder::TreeCallback& onTree, const SolveOptions& options);
+
+private:
+    /// A biconnected block with more than one edge, and its trees found so far.
+    struct Block
+    {
+        Graph graph;                       ///< The block, with its own vertex numbers.
+        Vector<int> edges;                 ///< Edge of the graph for every edge of the block.
+        std::unique_ptr<SolveState> state; ///< Search of the block, null until it starts and once it's done.
+        bool complete = false;             ///< Every tree of the block was found.
+        Vector<int> costs;                 ///< Costs of the trees found, ascending.
+        Vector<int> trees;                 ///< Edges of the graph, |V| - 1 of the block per tree.
+    };
+
+    const Graph& graph;
+    std::vector<Block> blocks;
+    Vector<int> bridges;  ///< Edges of the graph that are blocks of their own.
+    int bridgeCost = 0;
+
+    /// @brief Finds the blocks with an iterative depth-first search (Tarjan's low links).
+    void decompose();
+
+    /// @brief Searches a block until its i-th tree is found.
+    /// @return `false` if the block has no more than i trees.
+    bool fetch(Block& block, size_t i, const SolveOptions& options);
+};
+
+#endif // __BLOCK_SOLVER_H
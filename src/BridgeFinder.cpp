@@ -0,0 +1,87 @@
+#include "BridgeFinder.h"
+#include "Partition.h"
+
+#include <algorithm>
+
+BridgeFinder::BridgeFinder(const Graph& g)
+: edges(g.Edges()),
+  offsets(g.VertexCount() + 1, 0),
+  neighbours(2 * g.EdgeCount(), 0),
+  incident(2 * g.EdgeCount(), 0),
+  bridges(g.EdgeCount(), 0),
+  discovered(g.VertexCount()),
+  low(g.VertexCount())
+{
+    const size_t vertexCount = g.VertexCount();
+
+    for (const Edge& e : edges) {
+        offsets[e.nodeX + 1]++;
+        offsets[e.nodeY + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+
+    Vector<int> fill(offsets);
+    for (size_t i = 0; i < edges.Size(); ++i) {
+        const int x = edges[i].nodeX, y = edges[i].nodeY;
+        neighbours[fill[x]] = y;
+        incident[fill[x]++] = i;
+        neighbours[fill[y]] = x;
+        incident[fill[y]++] = i;
+    }
+}
+
+size_t BridgeFinder::Find(const Partition::Choices& choices)
+{
+    const bool all = choices.Empty();
+    std::ranges::fill(bridges, 0);
+    std::ranges::fill(discovered, -1);
+
+    int time = 0;
+    size_t components = 0;
+
+    for (size_t root = 0; root < discovered.size(); ++root) {
+        if (discovered[root] >= 0)
+            continue;
+
+        components++;
+        discovered[root] = low[root] = time++;
+        stack.emplace_back(root, -1, offsets[root]);
+
+        while (!stack.empty()) {
+            auto& [v, via, next] = stack.back();
+
+            if (next < offsets[v + 1]) {
+                const int u = neighbours[next], e = incident[next];
+                next++;
+                if (e == via || (!all && choices[e] == Partition::EXCLUDED))
+                    continue;
+                if (discovered[u] < 0) {
+                    discovered[u] = low[u] = time++;
+                    stack.emplace_back(u, e, offsets[u]);
+                } else {
+                    low[v] = std::min(low[v], discovered[u]);
+                }
+                continue;
+            }
+
+            // All of v is explored, pass its low link up to the parent.
+            const int vertex = v, edge = via;
+            stack.pop_back();
+            if (edge < 0)
+                continue;
+
+            const int parent = edges[edge].nodeX == vertex ? edges[edge].nodeY : edges[edge].nodeX;
+            low[parent] = std::min(low[parent], low[vertex]);
+            if (low[vertex] > discovered[parent])
+                bridges[edge] = 1;
+        }
+    }
+
+    return components;
+}
+
+size_t BridgeFinder::BridgeCount() const
+{
+    return std::ranges::count(bridges, 1);
+}
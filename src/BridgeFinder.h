@@ -0,0 +1,51 @@
+#ifndef __BRIDGE_FINDER_H
+#define __BRIDGE_FINDER_H
+
+#include "Graph.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+/// @brief Finds the bridges of a graph, or of what's left of it once some edges are excluded.
+///
+/// A bridge is an edge whose removal disconnects its component, so it's in
+/// every spanning tree. The adjacency of the graph is built once, a search
+/// then takes a single iterative depth-first pass (Tarjan's low links) over
+/// the edges that aren't excluded, reusing the buffers of the previous one.
+class BridgeFinder
+{
+public:
+    /// @brief Builds the adjacency of the graph.
+    /// @param g The graph, only its edges are kept.
+    explicit BridgeFinder(const Graph& g);
+
+    /// @brief Marks the bridges of the graph without the excluded edges.
+    /// @param choices A Partition::EdgeChoice per edge, empty to keep all the edges.
+    /// @return The number of connected components.
+    size_t Find(const Partition::Choices& choices = Partition::Choices());
+
+    /// @brief Checks an edge against the last search.
+    [[nodiscard]]
+    bool IsBridge(size_t edge) const { return bridges[edge]; }
+
+    /// @brief Counts the bridges of the last search.
+    [[nodiscard]]
+    size_t BridgeCount() const;
+
+private:
+    Vector<Edge> edges;
+    Vector<int> offsets;     ///< First adjacency of every vertex, and one past the last.
+    Vector<int> neighbours;  ///< Vertex at the other end of every adjacency.
+    Vector<int> incident;    ///< Edge of every adjacency.
+    Vector<char> bridges;    ///< Per edge.
+
+    std::vector<int> discovered, low;
+
+    /// (vertex, edge it was reached by, next adjacency to look at)
+    std::vector<std::tuple<int, int, int>> stack;
+};
+
+#endif // __BRIDGE_FINDER_H
@@ -0,0 +1,69 @@
+#include "Checkpoint.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static constexpr char CHECKPOINT_MAGIC[8] = { 'K', 'M', 'S', 'T', 'C', 'K', 'P', 'T' };
+static constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+void Checkpoint::Write(
+    const std::string& path, const Graph& g, size_t emitted, PartitionQueue& frontier)
+{
+    TraceScope span("checkpoint");
+
+    CheckpointHeader header{};
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.vertexCount = g.VertexCount();
+    header.graphHash = g.Hash();
+    header.emitted = emitted;
+    header.partitionCount = frontier.Size();
+
+    // A kill in the middle of writing must not destroy the previous checkpoint.
+    const std::string tmpPath = path + ".tmp";
+
+    std::ofstream output(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!output)
+        throw std::runtime_error("Can't create checkpoint '" + tmpPath + "'");
+
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    frontier.Save(output);
+    output.close();
+
+    if (!output || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Can't write checkpoint '" + path + "'");
+}
+
+static bool readHeader(std::istream& input, CheckpointHeader& header)
+{
+    return input.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+           memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == CHECKPOINT_VERSION;
+}
+
+bool Checkpoint::ReadHeader(const std::string& path, CheckpointHeader& header)
+{
+    std::ifstream input(path, std::ios::binary);
+    return input && readHeader(input, header);
+}
+
+size_t Checkpoint::Read(const std::string& path, const Graph& g, PartitionQueue& frontier)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+        throw std::runtime_error("Can't open checkpoint '" + path + "'");
+
+    CheckpointHeader header;
+    if (!readHeader(input, header))
+        throw std::runtime_error("'" + path + "' is not a checkpoint");
+
+    if (header.vertexCount != g.VertexCount() || header.graphHash != g.Hash())
+        throw std::runtime_error("Checkpoint '" + path + "' belongs to another graph");
+
+    frontier.Load(input, header.partitionCount);
+
+    return header.emitted;
+}
@@ -0,0 +1,66 @@
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+#include "Graph.h"
+#include "PartitionQueue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// @brief Header of a checkpoint file, all fields are little-endian.
+///
+/// The header is followed by the frontier of the search at the time of
+/// the checkpoint, `partitionCount` partitions written by PartitionQueue::Save.
+struct CheckpointHeader
+{
+    char magic[8];           ///< "KMSTCKPT"
+    uint32_t version;        ///< Format version.
+    uint32_t vertexCount;    ///< |V| of the graph.
+    uint64_t graphHash;      ///< Graph::Hash of the graph.
+    uint64_t emitted;        ///< Trees handed out before the checkpoint.
+    uint64_t partitionCount; ///< Partitions of the frontier.
+};
+
+/// @brief Saves and restores the state of SpanningTreesFinder::Solve.
+///
+/// The state of the search is fully described by its frontier and the
+/// number of trees handed out so far (the parents of later trees refer
+/// to the output order). A search restored from a checkpoint continues
+/// with exactly the trees that come next.
+class Checkpoint
+{
+public:
+    /// @brief Writes a checkpoint, replacing the file only once it's complete.
+    /// @param path The path of the checkpoint file.
+    /// @param g The graph being searched.
+    /// @param emitted Trees handed out so far.
+    /// @param frontier The partitions still to be searched.
+    /// @throws std::runtime_error if the file can't be written.
+    static void Write(
+        const std::string& path,
+        const Graph& g,
+        size_t emitted,
+        PartitionQueue& frontier
+    );
+
+    /// @brief Reads only the header of a checkpoint.
+    /// @param path The path of the checkpoint file.
+    /// @param header Receives the header.
+    /// @return `false` if the file can't be read or isn't a checkpoint.
+    static bool ReadHeader(const std::string& path, CheckpointHeader& header);
+
+    /// @brief Reads a checkpoint into an empty queue.
+    /// @param path The path of the checkpoint file.
+    /// @param g The graph being searched, must be the one of the checkpoint.
+    /// @param frontier Receives the partitions still to be searched.
+    /// @return The number of trees handed out before the checkpoint.
+    /// @throws std::runtime_error if the file is invalid or belongs to another graph.
+    static size_t Read(
+        const std::string& path,
+        const Graph& g,
+        PartitionQueue& frontier
+    );
+};
+
+#endif // __CHECKPOINT_H
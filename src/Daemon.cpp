@@ -0,0 +1,241 @@
+#include "Daemon.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <utility>
+
+Daemon::Session::Session(Graph g, const SolveOptions& options)
+: graph(std::move(g)), state(graph, options)
+{}
+
+Daemon::Daemon(const SolveOptions& options)
+: options(options)
+{
+    // A checkpoint holds a single search, the daemon keeps many.
+    this->options.checkpointPath.clear();
+    this->options.resumePath.clear();
+}
+
+bool Daemon::Serve(FILE* input, FILE* output)
+{
+    OutputBuffer out(output, 1 << 16);
+    char* line = nullptr;
+    size_t lineCapacity = 0;
+    bool running = true;
+
+    for (ssize_t length; running && (length = getline(&line, &lineCapacity, input)) >= 0; ) {
+        std::string request(line, length);
+        while (!request.empty() && (request.back() == '\n' || request.back() == '\r'))
+            request.pop_back();
+
+        if (request.empty())
+            continue;
+
+        try {
+            running = handle(request, out);
+        } catch (const std::exception& e) {
+            out << "ERROR " << std::string_view(e.what()) << '\n';
+        }
+        out.Flush();
+    }
+
+    free(line);
+    return running;
+}
+
+void Daemon::Listen(const std::string& socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path '" + socketPath + "' is too long");
+    strcpy(address.sun_path, socketPath.c_str());
+
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw std::runtime_error("Can't create a socket");
+
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listener, 16) < 0) {
+        close(listener);
+        throw std::runtime_error("Can't listen on '" + socketPath + "'");
+    }
+
+    // A client leaving early must not take the daemon down with it.
+    signal(SIGPIPE, SIG_IGN);
+
+    for (bool running = true; running; ) {
+        const int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+            continue;
+
+        FILE* input = fdopen(connection, "r");
+        FILE* output = fdopen(dup(connection), "w");
+        if (input && output)
+            running = Serve(input, output);
+
+        if (output)
+            fclose(output);
+        if (input)
+            fclose(input);
+        else
+            close(connection);
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+}
+
+Daemon::Session& Daemon::session(const std::string& name)
+{
+    const auto it = sessions.find(name);
+    if (it == sessions.end())
+        throw std::runtime_error("No graph '" + name + "' is loaded");
+    return *it->second;
+}
+
+void Daemon::extend(Session& s, const size_t k)
+{
+    if (s.costs.Size() >= k || s.state.Finished())
+        return;
+
+    TraceScope span("extend");
+
+    SolveOptions stepOptions = options;
+    stepOptions.treeLimit = k;
+
+    SpanningTreesFinder::Solve(s.graph, s.state, [&s](const Partition& p) {
+        s.costs.PushBack(p.mstCost);
+        for (const int e : p.mstEdges)
+            s.edges.PushBack(e);
+        return true;
+    }, stepOptions);
+}
+
+Reweighting::Report Daemon::reweight(Session& s, const Vector<WeightUpdate>& updates)
+{
+    TraceScope span("reweight");
+
+    const size_t treeEdgeCount = s.graph.VertexCount() - 1;
+    Vector<Partition> emitted;
+    for (size_t i = 0; i < s.costs.Size(); ++i) {
+        Partition tree(0);
+        tree.mstCost = s.costs[i];
+        for (size_t j = 0; j < treeEdgeCount; ++j)
+            tree.mstEdges.PushBack(s.edges[i * treeEdgeCount + j]);
+        emitted.PushBack(std::move(tree));
+    }
+
+    Reweighting::Report report;
+    s.graph = Reweighting::Apply(s.graph, updates, s.state, emitted, &report);
+
+    // The trees come again, ranked by the new weights.
+    s.costs.Clear();
+    s.edges.Clear();
+    return report;
+}
+
+bool Daemon::handle(const std::string& line, OutputBuffer& out)
+{
+    std::istringstream ss(line);
+    std::string command, name;
+    ss >> command;
+
+    if (command == "quit") {
+        out << "OK\n";
+        return false;
+    }
+
+    if (command == "list") {
+        out << "OK " << sessions.size() << '\n';
+        for (const auto& [n, s] : sessions)
+            out << n << ' ' << s->graph.VertexCount() << ' ' << s->graph.EdgeCount()
+                << ' ' << s->costs.Size() << '\n';
+        return true;
+    }
+
+    if (!(ss >> name))
+        throw std::runtime_error("Malformed request: " + line);
+
+    if (command == "load") {
+        std::string path;
+        if (!(ss >> path))
+            throw std::runtime_error("Malformed request: " + line);
+
+        TraceScope span("load");
+        Graph g = SpanningTreesFinder::ReadGraph(path);
+        if (!g.VertexCount() || !g.EdgeCount())
+            throw std::runtime_error("Cannot solve for a tree with no vertices or edges");
+
+        auto s = std::make_unique<Session>(std::move(g), options);
+        out << "OK " << s->graph.VertexCount() << ' ' << s->graph.EdgeCount() << '\n';
+        sessions[name] = std::move(s);
+        return true;
+    }
+
+    if (command == "unload") {
+        if (sessions.erase(name) == 0)
+            throw std::runtime_error("No graph '" + name + "' is loaded");
+        out << "OK\n";
+        return true;
+    }
+
+    if (command == "info") {
+        const Session& s = session(name);
+        out << "OK " << s.graph.VertexCount() << ' ' << s.graph.EdgeCount() << ' '
+            << s.costs.Size() << ' ' << (s.state.Finished() ? 1 : 0) << '\n';
+        return true;
+    }
+
+    if (command == "reweight") {
+        Vector<int> numbers;
+        for (int n; ss >> n; )
+            numbers.PushBack(n);
+
+        if (numbers.Empty() || numbers.Size() % 3 != 0 || !ss.eof())
+            throw std::runtime_error("Malformed request: " + line);
+
+        Vector<WeightUpdate> updates;
+        for (size_t i = 0; i < numbers.Size(); i += 3)
+            updates.PushBack({ numbers[i], numbers[i + 1], numbers[i + 2] });
+
+        Session& s = session(name);
+        const Reweighting::Report report = reweight(s, updates);
+        out << "OK " << report.partitions << ' ' << report.repaired << ' ' << report.swaps << '\n';
+        return true;
+    }
+
+    if (command == "trees") {
+        size_t first = 0, last = 0;
+        if (!(ss >> first >> last) || first == 0 || last < first)
+            throw std::runtime_error("Malformed request: " + line);
+
+        Session& s = session(name);
+        extend(s, last);
+
+        // A graph with fewer trees answers with what it has.
+        const size_t treeEdgeCount = s.graph.VertexCount() - 1;
+        last = std::min(last, s.costs.Size());
+        out << "OK " << (last >= first ? last - first + 1 : 0) << '\n';
+
+        for (size_t i = first - 1; i < last; ++i) {
+            out << s.costs[i] << ':';
+            for (size_t j = 0; j < treeEdgeCount; ++j)
+                out << ' ' << s.edges[i * treeEdgeCount + j];
+            out << '\n';
+        }
+        return true;
+    }
+
+    throw std::runtime_error("Unknown request: " + command);
+}
@@ -0,0 +1,84 @@
+#ifndef __DAEMON_H
+#define __DAEMON_H
+
+#include "Graph.h"
+#include "OutputBuffer.h"
+#include "Reweighting.h"
+#include "SpanningTreesFinder.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+
+/// @brief Answers tree queries over a line protocol, keeping the searches warm between them.
+///
+/// Every loaded graph keeps its search (SolveState) and the trees emitted
+/// so far. A query for trees already emitted is answered from memory, a
+/// query going further continues the search where the previous one
+/// stopped. Requests are single lines, responses start with `OK` or with
+/// `ERROR <message>`:
+///
+///     load <name> <file>       reads an adjacency matrix, `OK |V| |E|`
+///     trees <name> <k1> <k2>   trees k1..k2 (1-based, inclusive), `OK n`
+///                              and n lines of the text result format
+///     reweight <name> <x> <y> <w> [<x> <y> <w> ...]
+///                              sets new weights of edges and re-ranks the search,
+///                              `OK spaces repaired swaps`, the trees start over
+///     info <name>              `OK |V| |E| emitted finished`
+///     unload <name>            forgets the graph and its search
+///     list                     `OK n` and a line `name |V| |E| emitted` per graph
+///     quit                     stops the daemon
+class Daemon
+{
+public:
+    /// @brief Constructs a daemon without any graphs.
+    /// @param options Options of every search, checkpoints aren't supported.
+    explicit Daemon(const SolveOptions& options = SolveOptions());
+
+    /// @brief Answers requests until the input ends or `quit` comes.
+    /// @param input The file the requests are read from.
+    /// @param output The file the responses are written to, flushed after each one.
+    /// @return `false` if `quit` was requested.
+    bool Serve(FILE* input, FILE* output);
+
+    /// @brief Listens on a Unix socket, serving one connection at a time until `quit`.
+    /// @param socketPath Path of the socket, an existing file there is replaced.
+    /// @throws std::runtime_error if the socket can't be created.
+    void Listen(const std::string& socketPath);
+
+private:
+    /// A loaded graph with its search.
+    struct Session
+    {
+        explicit Session(Graph g, const SolveOptions& options);
+
+        Graph graph;
+        SolveState state;
+        Vector<int> costs; ///< Cost of every emitted tree.
+        Vector<int> edges; ///< Edges of every emitted tree, |V|-1 per tree.
+    };
+
+    SolveOptions options;
+    std::map<std::string, std::unique_ptr<Session>> sessions;
+
+    /// @brief Answers a single request.
+    /// @return `false` if it was `quit`.
+    /// @throws std::runtime_error on a malformed request.
+    bool handle(const std::string& line, OutputBuffer& out);
+
+    /// @brief Finds a loaded graph.
+    /// @throws std::runtime_error if there's no graph of the name.
+    Session& session(const std::string& name);
+
+    /// @brief Continues the search of a graph until it emitted k trees or ran out of them.
+    void extend(Session& s, size_t k);
+
+    /// @brief Changes edge weights of a graph, re-ranking its search instead of starting over.
+    /// @return What the repair did.
+    Reweighting::Report reweight(Session& s, const Vector<WeightUpdate>& updates);
+};
+
+#endif // __DAEMON_H
@@ -0,0 +1,161 @@
+#include "DeltaEncoding.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+DeltaWindow::DeltaWindow(const size_t treeEdgeCount)
+: treeEdgeCount(treeEdgeCount),
+  window(std::max<size_t>(1, WINDOW_BYTES / (std::max<size_t>(1, treeEdgeCount) * sizeof(int))))
+{
+}
+
+const int* DeltaWindow::Tree(const size_t index) const
+{
+    return index == 0 ? mst.begin() : ring.begin() + (index % window) * treeEdgeCount;
+}
+
+void DeltaWindow::Push(const Vector<int>& edges)
+{
+    if (count == 0)
+        for (const int e : edges)
+            mst.PushBack(e);
+
+    // The ring fills up first, then every tree takes the slot of the one `window` before it.
+    if (count < window) {
+        for (const int e : edges)
+            ring.PushBack(e);
+    } else {
+        std::ranges::copy(edges, ring.begin() + (count % window) * treeEdgeCount);
+    }
+
+    count++;
+}
+
+DeltaWriter::DeltaWriter(OutputBuffer& output, const Graph& g)
+: output(output), treeEdgeCount(g.VertexCount() - 1), written(g.VertexCount() - 1)
+{
+    output << "# kthmst-delta " << g.VertexCount() << ' ' << g.EdgeCount() << '\n';
+}
+
+size_t DeltaWriter::diff(const size_t ref, const Partition& p)
+{
+    removed.Clear();
+    added.Clear();
+
+    // Both edge lists are sorted by index, a single merge finds the difference.
+    const int* r = written.Tree(ref);
+    const int* rEnd = r + treeEdgeCount;
+    const int* t = p.mstEdges.begin();
+    const int* tEnd = p.mstEdges.end();
+
+    while (r != rEnd || t != tEnd) {
+        if (t == tEnd || (r != rEnd && *r < *t)) {
+            removed.PushBack(*r++);
+        } else if (r == rEnd || *t < *r) {
+            added.PushBack(*t++);
+        } else {
+            r++;
+            t++;
+        }
+    }
+
+    return removed.Size();
+}
+
+void DeltaWriter::Append(const Partition& p)
+{
+    if (p.mstEdges.Size() != treeEdgeCount)
+        throw std::runtime_error("Tree has a wrong number of edges");
+
+    // The reference must already be written and still kept, the MST is always tree 0.
+    int ref = -1;
+    if (written.Count() > 0 && std::ranges::is_sorted(p.mstEdges)) {
+        ref = 0;
+        if (p.parent > 0 && written.Holds(p.parent) && diff(p.parent, p) < diff(0, p))
+            ref = p.parent;
+    }
+
+    output << p.mstCost << ' ';
+
+    if (ref < 0) {
+        output << "*:";
+        for (const int e : p.mstEdges)
+            output << ' ' << e;
+    } else {
+        diff(ref, p);
+        output << ref << ':';
+        for (size_t i = 0; i < removed.Size(); ++i)
+            output << ' ' << removed[i] << '>' << added[i];
+    }
+
+    output << '\n';
+
+    written.Push(p.mstEdges);
+}
+
+DeltaReader::DeltaReader(std::istream& input)
+: input(input)
+{
+    std::string hash, magic;
+    input >> hash >> magic >> vertexCount >> edgeCount;
+
+    if (!input || hash != "#" || magic != "kthmst-delta" || vertexCount == 0)
+        throw std::runtime_error("Not a delta file");
+
+    decoded = DeltaWindow(vertexCount - 1);
+}
+
+bool DeltaReader::Next(Partition& p)
+{
+    std::string line;
+    do {
+        if (!std::getline(input, line))
+            return false;
+    } while (line.empty() || line[0] == '#');
+
+    std::istringstream ss(line);
+    std::string ref;
+    p.Reset();
+    ss >> p.mstCost >> ref;
+
+    if (!ss || ref.empty() || ref.back() != ':')
+        throw std::runtime_error("Malformed delta line: " + line);
+
+    const size_t treeEdgeCount = vertexCount - 1;
+
+    if (ref == "*:") {
+        for (int e; ss >> e; )
+            p.mstEdges.PushBack(e);
+    } else {
+        const size_t refIndex = std::stoul(ref);
+        if (refIndex >= decoded.Count())
+            throw std::runtime_error("Delta line refers to a later tree: " + line);
+        if (!decoded.Holds(refIndex))
+            throw std::runtime_error("Delta line refers to a tree out of the window: " + line);
+
+        p.parent = refIndex;
+        const int* r = decoded.Tree(refIndex);
+        for (size_t i = 0; i < treeEdgeCount; ++i)
+            p.mstEdges.PushBack(r[i]);
+
+        int removedEdge, addedEdge;
+        char arrow;
+        while (ss >> removedEdge >> arrow >> addedEdge) {
+            int* it = std::ranges::find(p.mstEdges, removedEdge);
+            if (arrow != '>' || it == p.mstEdges.end())
+                throw std::runtime_error("Malformed delta line: " + line);
+            *it = addedEdge;
+        }
+
+        std::ranges::sort(p.mstEdges);
+    }
+
+    if (p.mstEdges.Size() != treeEdgeCount)
+        throw std::runtime_error("Delta line has a wrong number of edges: " + line);
+
+    decoded.Push(p.mstEdges);
+
+    return true;
+}
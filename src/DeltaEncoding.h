@@ -0,0 +1,117 @@
+#ifndef __DELTA_ENCODING_H
+#define __DELTA_ENCODING_H
+
+#include "Graph.h"
+#include "OutputBuffer.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <istream>
+
+/// @brief The earlier trees a delta line can refer to.
+///
+/// Keeping every tree would grow with the output, so only the MST and the
+/// last trees that fit in WINDOW_BYTES are kept, in a ring. A parent further
+/// back is rarely a closer reference than the MST anyway. The window depends
+/// only on |V|, the writer and the reader keep the same one and the
+/// references of a file always fall within it.
+class DeltaWindow
+{
+public:
+    static constexpr size_t WINDOW_BYTES = 16 << 20; ///< Memory of the ring.
+
+    /// @param treeEdgeCount |V|-1
+    explicit DeltaWindow(size_t treeEdgeCount);
+
+    /// @brief Checks if an earlier tree is still kept.
+    [[nodiscard]]
+    bool Holds(size_t index) const { return index < count && (index == 0 || count - index <= window); }
+
+    /// @brief Retrieves the edges of a kept tree.
+    /// @param index The index of the tree, Holds must be `true` for it.
+    /// @return The |V|-1 edges of the tree.
+    [[nodiscard]]
+    const int* Tree(size_t index) const;
+
+    /// @brief Keeps the next tree, dropping the oldest one out of the window.
+    /// @param edges The |V|-1 edges of the tree.
+    void Push(const Vector<int>& edges);
+
+    /// @brief Retrieves the number of trees pushed so far.
+    [[nodiscard]]
+    size_t Count() const { return count; }
+
+private:
+    size_t treeEdgeCount;
+    size_t window;     ///< Trees kept besides the MST.
+    size_t count = 0;  ///< Trees pushed so far.
+    Vector<int> mst;   ///< Edges of tree 0.
+    Vector<int> ring;  ///< Edges of the last `window` trees, tree i in slot i % window.
+};
+
+/// @brief Writes trees as edge swaps relative to an earlier tree.
+///
+/// A tree coming out of SpanningTreesFinder::Solve usually differs from
+/// the tree of its parent partition (or from the MST) by one or two edges.
+/// Each tree is written as a line `cost ref: r>a r>a ...`, where `ref` is
+/// the index of the reference tree and every `r>a` swap removes edge `r`
+/// and adds edge `a`. The MST (and any tree without a reference) is
+/// written in full as `cost *: e1 e2 ...`. The file starts with the header
+/// `# kthmst-delta |V| |E|`. A reference is the MST or one of the trees in
+/// the DeltaWindow, the memory doesn't grow with the number of trees.
+class DeltaWriter
+{
+public:
+    /// @brief Writes the header.
+    /// @param output The output buffer to write to.
+    /// @param g The graph the trees belong to.
+    DeltaWriter(OutputBuffer& output, const Graph& g);
+
+    /// @brief Writes the next tree, against its parent or the MST, whichever differs less.
+    ///
+    /// A parent that already left the window isn't considered.
+    /// @param p The partition holding the tree, its `parent` refers to the output order.
+    void Append(const Partition& p);
+
+    /// @brief Retrieves the number of trees written so far.
+    [[nodiscard]]
+    size_t TreeCount() const { return written.Count(); }
+
+private:
+    OutputBuffer& output;
+    size_t treeEdgeCount;       ///< |V|-1
+    DeltaWindow written;        ///< The written trees a later one can refer to.
+    Vector<int> removed, added; ///< Scratch space of the swaps.
+
+    /// @brief Computes the swaps turning a written tree into the given one.
+    /// @return The number of swaps, they are left in `removed` and `added`.
+    size_t diff(size_t ref, const Partition& p);
+};
+
+/// @brief Reads trees back from a file written by DeltaWriter.
+class DeltaReader
+{
+public:
+    /// @brief Reads the header.
+    /// @param input The input stream to read from.
+    /// @throws std::runtime_error if the stream doesn't start with a valid header.
+    explicit DeltaReader(std::istream& input);
+
+    [[nodiscard]] size_t VertexCount() const { return vertexCount; } ///< |V| of the graph.
+    [[nodiscard]] size_t EdgeCount() const { return edgeCount; }     ///< |E| of the graph.
+
+    /// @brief Decodes the next tree.
+    /// @param p Receives the tree (without choices), its `parent` is set to the reference.
+    /// @return `false` when there are no more trees.
+    /// @throws std::runtime_error on a malformed line or a reference out of the window.
+    bool Next(Partition& p);
+
+private:
+    std::istream& input;
+    size_t vertexCount = 0;
+    size_t edgeCount = 0;
+    DeltaWindow decoded{0}; ///< The decoded trees a later one can refer to.
+};
+
+#endif // __DELTA_ENCODING_H
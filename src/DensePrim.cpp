@@ -0,0 +1,100 @@
+#include "DensePrim.h"
+
+#include <algorithm>
+#include <climits>
+
+DensePrim::DensePrim(const Graph& g)
+: vertexCount(g.VertexCount()),
+  edgeCount(g.EdgeCount()),
+  weights(g.EdgeCount(), 0),
+  adjacency(g.VertexCount() * g.VertexCount(), (int)g.EdgeCount()),
+  edgeRank(g.EdgeCount() + 1, INT_MAX),
+  rank(g.VertexCount(), 0),
+  remaining(g.VertexCount(), 0)
+{
+    for (size_t i = 0; i < edgeCount; ++i) {
+        const Edge& e = g.Edges()[i];
+        weights[i] = e.weight;
+        adjacency[e.nodeX * vertexCount + e.nodeY] = i;
+        adjacency[e.nodeY * vertexCount + e.nodeX] = i;
+    }
+}
+
+Partition* DensePrim::CreatePartition(const Partition::Choices& choices, [[maybe_unused]] SolveStats* stats)
+{
+    const int m = (int)edgeCount;
+    const Partition::EdgeChoice* choice = choices.begin();
+
+    // Included edges rank below all the others, excluded ones are as good as missing.
+    int* const ranks = edgeRank.begin();
+    for (int e = 0; e < m; ++e)
+        ranks[e] = choice[e] == Partition::EXCLUDED ? INT_MAX : choice[e] == Partition::INCLUDED ? e - m : e;
+
+    // The best rank to the tree per vertex, the vertices not in it are kept packed in front.
+    int* const best = rank.begin();
+    int* const rest = remaining.begin();
+    for (size_t u = 0; u < vertexCount; ++u) {
+        best[u] = INT_MAX;
+        rest[u] = (int)u;
+    }
+
+    Vector<int> mstEdges(vertexCount - 1);
+    int mstCost = 0;
+
+    // The tree grows from vertex 0, every step reads the row of the vertex added last.
+    size_t v = 0;
+    size_t left = vertexCount - 1;
+    rest[0] = rest[left];
+
+    while (left > 0) {
+        const int* row = adjacency.begin() + v * vertexCount;
+
+        int closest = INT_MAX;
+        size_t at = 0;
+        for (size_t j = 0; j < left; ++j) {
+            const int u = rest[j];
+            const int r = std::min(best[u], ranks[row[u]]);
+            best[u] = r;
+            if (r < closest) {
+                closest = r;
+                at = j;
+            }
+        }
+
+        // Nothing reaches the rest, the space is disconnected.
+        if (closest == INT_MAX) {
+            SOLVE_STAT(stats, createPartitionCalls++);
+            SOLVE_STAT(stats, primCalls++);
+            return nullptr;
+        }
+
+        v = rest[at];
+        rest[at] = rest[--left];
+
+        const int e = closest < 0 ? closest + m : closest;
+        mstEdges.PushBack(e);
+        mstCost += weights[e];
+    }
+
+    // Every added vertex read its row, as far as the vertices still out.
+    SOLVE_STAT(stats, createPartitionCalls++);
+    SOLVE_STAT(stats, primCalls++);
+    SOLVE_STAT(stats, edgesScanned += vertexCount * (vertexCount - 1) / 2);
+
+    std::ranges::sort(mstEdges);
+    return new Partition(choices, mstCost, mstEdges);
+}
+
+bool DensePrim::Faster(const size_t vertexCount, const size_t edgeCount, const double depth)
+{
+    // Nanoseconds fitted to the mst/ microbenchmarks. Kruskal's reads a
+    // choice per edge and then unites the scanned ones, Prim's ranks the
+    // edges and reads half of the matrix. On a complete graph Prim's wins
+    // once Kruskal's scans over about 5% of the edges.
+    const double KRUSKAL_CHOICE = 4.2, KRUSKAL_EDGE = 20.0;
+    const double PRIM_RANK = 2.5, PRIM_ENTRY = 2.8;
+
+    const double kruskal = KRUSKAL_CHOICE * edgeCount + KRUSKAL_EDGE * depth * edgeCount;
+    const double prim = PRIM_RANK * edgeCount + PRIM_ENTRY * vertexCount * (vertexCount - 1) / 2;
+    return prim < kruskal;
+}
@@ -0,0 +1,61 @@
+#ifndef __DENSE_PRIM_H
+#define __DENSE_PRIM_H
+
+#include "Graph.h"
+#include "Partition.h"
+#include "SolveStats.h"
+#include "Vector.h"
+
+#include <cstddef>
+
+/// @brief Finds the MST of a search space with Prim's algorithm over an adjacency matrix.
+///
+/// Kruskal's algorithm (SpanningTreesFinder::CreatePartition) walks the
+/// sorted edges until the space is connected, on a complete graph that's a
+/// good part of its |V|^2/2 edges with two finds each. Here the graph is
+/// kept as a |V| x |V| matrix of edge indices, every vertex added to the
+/// tree reads its row once and the next one is the closest of the rest, no
+/// union-find involved.
+///
+/// The edges are ranked by their index, which orders them by weight and
+/// breaks the ties, the included ones before all the others. Under a strict
+/// order the MST is unique, so the tree is exactly the one Kruskal's finds,
+/// the two can be swapped at any point of a search.
+class DensePrim
+{
+public:
+    /// @brief Builds the adjacency matrix of the graph.
+    /// @param g The graph, its edges sorted by their weights.
+    explicit DensePrim(const Graph& g);
+
+    /// @brief Finds the MST of a search space.
+    /// @param choices A Partition::EdgeChoice per edge.
+    /// @param stats Counts the call and the scanned matrix entries, if not null.
+    /// @return The partition with its tree, or nullptr if the space has no spanning tree.
+    [[nodiscard]]
+    Partition* CreatePartition(const Partition::Choices& choices, SolveStats* stats = nullptr);
+
+    /// @brief Estimates which of the two algorithms finds a tree of the graph faster.
+    ///
+    /// Kruskal's pass reads every choice and then the edges up to the last
+    /// one it needs, Prim's ranks every edge and reads half of the matrix.
+    /// The costs per step are measured by `kthmst microbench --filter mst/`.
+    /// @param vertexCount |V| of the graph.
+    /// @param edgeCount |E| of the graph.
+    /// @param depth Expected share of the edges Kruskal's scans, 0 to 1.
+    /// @return `true` if Prim's is expected to be faster.
+    [[nodiscard]]
+    static bool Faster(size_t vertexCount, size_t edgeCount, double depth);
+
+private:
+    size_t vertexCount;
+    size_t edgeCount;
+    Vector<int> weights;    ///< Per edge.
+    Vector<int> adjacency;  ///< Edge between every two vertices, row by row, |E| for none.
+
+    Vector<int> edgeRank;   ///< Rank of every edge in the current space, INT_MAX for none.
+    Vector<int> rank;       ///< Best rank of an edge to the tree, per vertex.
+    Vector<int> remaining;  ///< Vertices not in the tree yet.
+};
+
+#endif // __DENSE_PRIM_H
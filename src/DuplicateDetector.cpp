@@ -0,0 +1,73 @@
+#include "DuplicateDetector.h"
+
+// SplitMix64, good enough for the Zobrist keys and cheap to seed.
+static uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+DuplicateDetector::DuplicateDetector(size_t edgeCount, uint64_t seed)
+: keys(edgeCount, Fingerprint{0, 0}), table(1024, Fingerprint{0, 0})
+{
+    for (size_t i = 0; i < edgeCount; ++i) {
+        keys[i].lo = splitMix64(seed);
+        keys[i].hi = splitMix64(seed);
+    }
+}
+
+DuplicateDetector::Fingerprint
+DuplicateDetector::Hash(const Partition& p) const
+{
+    Fingerprint fp{0, 0};
+    for (const int e : p.mstEdges) {
+        fp.lo ^= keys[e].lo;
+        fp.hi ^= keys[e].hi;
+    }
+
+    // The empty slot marker can't be a valid fingerprint,
+    // the chance of actually hitting it is 2^-128 anyway.
+    if (fp.lo == 0 && fp.hi == 0)
+        fp.lo = 1;
+
+    return fp;
+}
+
+bool DuplicateDetector::Insert(const Partition& p)
+{
+    // Keep the load factor under 1/2 so the probe sequences stay short.
+    if (2 * (count + 1) > table.Size())
+        grow();
+
+    return place(Hash(p));
+}
+
+bool DuplicateDetector::place(const Fingerprint& fp)
+{
+    const size_t mask = table.Size() - 1;
+
+    // Linear probing, the low half is already uniformly distributed.
+    for (size_t i = fp.lo & mask; ; i = (i + 1) & mask) {
+        if (table[i] == fp)
+            return false;
+
+        if (table[i].lo == 0 && table[i].hi == 0) {
+            table[i] = fp;
+            count++;
+            return true;
+        }
+    }
+}
+
+void DuplicateDetector::grow()
+{
+    Vector<Fingerprint> old(table.Size() * 2, Fingerprint{0, 0});
+    std::swap(old, table);
+    count = 0;
+
+    for (const Fingerprint& fp : old)
+        if (fp.lo != 0 || fp.hi != 0)
+            place(fp);
+}
@@ -0,0 +1,63 @@
+#ifndef __DUPLICATE_DETECTOR_H
+#define __DUPLICATE_DETECTOR_H
+
+#include "Partition.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Streaming duplicate detector for spanning trees.
+///
+/// Every edge of the graph gets a random 128-bit key. A tree is fingerprinted
+/// by XOR-ing the keys of its edges (Zobrist hashing), which makes the
+/// fingerprint independent of the edge order. Fingerprints are kept in an
+/// open-addressing hash set, so checking k trees takes O(k) time and
+/// 16 bytes per tree, without copying or sorting the trees themselves.
+class DuplicateDetector
+{
+public:
+    /// @brief 128-bit fingerprint of a set of edges.
+    struct Fingerprint
+    {
+        uint64_t lo;
+        uint64_t hi;
+
+        bool operator == (const Fingerprint& r) const { return lo == r.lo && hi == r.hi; }
+        bool operator != (const Fingerprint& r) const { return !(*this == r); }
+    };
+
+    /// @brief Constructs a detector for trees of a graph with the given edge count.
+    /// @param edgeCount The number of edges in the graph.
+    /// @param seed Seed of the per-edge random keys.
+    explicit DuplicateDetector(size_t edgeCount, uint64_t seed = 0x9E3779B97F4A7C15ull);
+
+    /// @brief Computes the fingerprint of the tree's edge set.
+    /// @param p The partition holding the tree.
+    /// @return The fingerprint of the tree.
+    [[nodiscard]]
+    Fingerprint Hash(const Partition& p) const;
+
+    /// @brief Remembers the tree.
+    /// @param p The partition holding the tree.
+    /// @return `true` if the tree was not seen before, otherwise `false`.
+    bool Insert(const Partition& p);
+
+    /// @brief Retrieves the number of distinct trees seen so far.
+    [[nodiscard]]
+    size_t Size() const { return count; }
+
+private:
+    Vector<Fingerprint> keys;  ///< Random key of every edge.
+    Vector<Fingerprint> table; ///< Open-addressing slots, {0,0} marks an empty slot.
+    size_t count = 0;          ///< Number of occupied slots.
+
+    /// @brief Places a fingerprint into the table.
+    /// @return `true` if it was not present yet.
+    bool place(const Fingerprint& fp);
+
+    /// @brief Doubles the table and re-inserts all fingerprints.
+    void grow();
+};
+
+#endif // __DUPLICATE_DETECTOR_H
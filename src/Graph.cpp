@@ -1,6 +1,7 @@
 #include "Graph.h"
 #include <cassert>
 #include <sstream>
+#include <utility>
 
 Graph::Graph(size_t vertexCount, Vector<Edge>& edges) : 
     vertexCount(vertexCount), 
@@ -8,6 +9,12 @@ Graph::Graph(size_t vertexCount, Vector<Edge>& edges) :
     edges(edges) 
 {}
 
+Graph::Graph(size_t vertexCount, Vector<Edge>&& edges) :
+    vertexCount(vertexCount),
+    edgeCount(edges.Size()),
+    edges(std::move(edges))
+{}
+
 Vector<Edge> 
 Graph::createEdges(const Matrix<int>& adjMat) 
 {
@@ -43,6 +50,27 @@ size_t Graph::VertexCount() const { return vertexCount; }
 size_t Graph::EdgeCount() const { return edgeCount;}
 const Vector<Edge>& Graph::Edges() const { return edges; }
 
+uint64_t Graph::Hash() const {
+    // FNV-1a over 64-bit words, mixed at the end so close graphs spread out.
+    uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&hash](const uint64_t word) {
+        hash ^= word;
+        hash *= 0x100000001B3ull;
+    };
+
+    mix(vertexCount);
+    mix(edgeCount);
+    for (const Edge& e : edges) {
+        mix(((uint64_t)(uint32_t)e.nodeX << 32) | (uint32_t)e.nodeY);
+        mix((uint64_t)(int64_t)e.weight);
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
 std::string Graph::ToString() const {
     std::stringstream ss;
     ss << "G = (V, E), |V| = " << this->vertexCount 
@@ -6,6 +6,7 @@
 #include "Matrix.h"
 #include "Vector.h"
 #include <cstddef>
+#include <cstdint>
 
 /// @brief Represents a graph consisting of vertices and edges.
 /// 
@@ -33,6 +34,11 @@ public:
     /// @param vertexCount The number of vertices in the graph.
     /// @param edges A vector of edges to initialize the graph.
     Graph(size_t vertexCount, Vector<Edge>& edges);
+
+    /// @brief Constructs a Graph taking over a vector of edges.
+    /// @param vertexCount The number of vertices in the graph.
+    /// @param edges The edges, sorted by their weights.
+    Graph(size_t vertexCount, Vector<Edge>&& edges);
     
     /// @brief Constructs a Graph from an adjacency matrix.
     /// @param adjMatrix The adjacency matrix to create the graph from.
@@ -50,6 +56,14 @@ public:
     /// @return A reference to the vector of edges.
     const Vector<Edge>& Edges() const;
 
+    /// @brief Computes a content hash of the graph.
+    /// 
+    /// The hash covers the vertex count and the edges with their weights in
+    /// their sorted order, i.e. exactly what the edge indices of a stored 
+    /// tree refer to. Equal adjacency matrices always give equal hashes.
+    /// @return A 64-bit hash of the graph.
+    uint64_t Hash() const;
+
     /// @brief Converts the graph to a string representation.
     /// 
     /// This function formats the graph as a string, including the counts of 
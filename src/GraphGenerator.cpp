@@ -0,0 +1,107 @@
+#include "GraphGenerator.h"
+
+#include <random>
+#include <stdexcept>
+
+static const char* FAMILY_NAMES[GraphGenerator::FAMILY_COUNT] = {
+    "complete", "grid", "sparse", "equal-weights", "near-tree",
+};
+
+const char* GraphGenerator::FamilyName(Family family)
+{
+    return FAMILY_NAMES[family];
+}
+
+bool GraphGenerator::ParseFamily(const std::string& name, Family& family)
+{
+    for (int f = 0; f < FAMILY_COUNT; ++f) {
+        if (name == FAMILY_NAMES[f]) {
+            family = (Family)f;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Joins two vertices, keeping the matrix symmetric.
+static void connect(int* elems, size_t n, size_t x, size_t y, int weight)
+{
+    elems[x * n + y] = weight;
+    elems[y * n + x] = weight;
+}
+
+/// Adds random edges on top of a random spanning tree,
+/// so the graph is connected whatever the edges are.
+static void treePlusEdges(int* elems, size_t n, size_t extra, int maxWeight, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<int> weight(1, maxWeight);
+
+    // Every vertex hangs on a random earlier one.
+    for (size_t v = 1; v < n; ++v)
+        connect(elems, n, v, std::uniform_int_distribution<size_t>(0, v - 1)(rng), weight(rng));
+
+    // Bounded attempts, a nearly complete graph has little room left.
+    std::uniform_int_distribution<size_t> vertex(0, n - 1);
+    for (size_t added = 0, tries = 0; added < extra && tries < 16 * extra + 16; ++tries) {
+        const size_t x = vertex(rng), y = vertex(rng);
+        if (x == y || elems[x * n + y] != 0)
+            continue;
+        connect(elems, n, x, y, weight(rng));
+        added++;
+    }
+}
+
+Matrix<int> GraphGenerator::Generate(Family family, size_t size, uint64_t seed)
+{
+    if (size < 2)
+        throw std::runtime_error("A generated graph needs at least 2 vertices");
+
+    std::mt19937_64 rng(seed);
+
+    const size_t n = family == GRID ? size * size : size;
+    int* elems = new int[n * n]();
+
+    switch (family) {
+    case COMPLETE:
+    case EQUAL_WEIGHTS: {
+        std::uniform_int_distribution<int> weight(1, family == COMPLETE ? 100 : 2);
+        for (size_t x = 0; x < n; ++x)
+            for (size_t y = x + 1; y < n; ++y)
+                connect(elems, n, x, y, weight(rng));
+        break;
+    }
+    case GRID: {
+        std::uniform_int_distribution<int> weight(1, 100);
+        for (size_t r = 0; r < size; ++r) {
+            for (size_t c = 0; c < size; ++c) {
+                if (c + 1 < size)
+                    connect(elems, n, r * size + c, r * size + c + 1, weight(rng));
+                if (r + 1 < size)
+                    connect(elems, n, r * size + c, (r + 1) * size + c, weight(rng));
+            }
+        }
+        break;
+    }
+    case SPARSE_RANDOM:
+        treePlusEdges(elems, n, size, 1000, rng);
+        break;
+    case NEAR_TREE:
+        treePlusEdges(elems, n, size / 10 + 1, 100, rng);
+        break;
+    default:
+        delete[] elems;
+        throw std::runtime_error("Unknown graph family");
+    }
+
+    return Matrix<int>(n, n, elems);
+}
+
+void GraphGenerator::Write(std::ostream& os, const Matrix<int>& adjMat)
+{
+    os << adjMat.Rows() << '\n';
+    for (size_t r = 0; r < adjMat.Rows(); ++r) {
+        for (size_t c = 0; c < adjMat.Columns(); ++c)
+            os << (c ? " " : "") << adjMat.Get(r, c);
+        os << '\n';
+    }
+}
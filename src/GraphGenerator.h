@@ -0,0 +1,49 @@
+#ifndef __GRAPH_GENERATOR_H
+#define __GRAPH_GENERATOR_H
+
+#include "Matrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// @brief Generates seeded random graphs for benchmarking.
+///
+/// Every family stresses the search differently: dense graphs have many
+/// children per partition, ties in the weights make long runs of trees of
+/// equal cost and near-trees have few spanning trees at all. The same
+/// family, size and seed always give the same adjacency matrix.
+class GraphGenerator
+{
+public:
+    enum Family {
+        COMPLETE,      ///< All vertex pairs connected, weights 1..100.
+        GRID,          ///< `size` x `size` grid, weights 1..100.
+        SPARSE_RANDOM, ///< Random spanning tree plus `size` random edges, weights 1..1000.
+        EQUAL_WEIGHTS, ///< Complete graph with weights 1 or 2 only.
+        NEAR_TREE,     ///< Random spanning tree plus `size`/10 random edges, weights 1..100.
+        FAMILY_COUNT,
+    };
+
+    /// @brief Retrieves the name of a family, as used on the command line.
+    [[nodiscard]]
+    static const char* FamilyName(Family family);
+
+    /// @brief Looks up a family by its name.
+    /// @return `false` if there is no such family.
+    static bool ParseFamily(const std::string& name, Family& family);
+
+    /// @brief Generates an adjacency matrix, every generated graph is connected.
+    /// @param family The family of the graph.
+    /// @param size The number of vertices, or the side of the grid.
+    /// @param seed The seed of the random number generator.
+    /// @return The adjacency matrix, 0 meaning no edge.
+    [[nodiscard]]
+    static Matrix<int> Generate(Family family, size_t size, uint64_t seed);
+
+    /// @brief Writes an adjacency matrix in the input file format.
+    static void Write(std::ostream& os, const Matrix<int>& adjMat);
+};
+
+#endif // __GRAPH_GENERATOR_H
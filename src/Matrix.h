@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <string>
 #include <iomanip>
+#include <utility>
 
 /// @brief A templated class representing a 2D matrix of type T.
 /// 
@@ -21,9 +22,9 @@
 template <Comparable T>
 class Matrix : public IToString
 {
-    size_t rows;     ///< Number of rows in the matrix.
-    size_t columns;  ///< Number of columns in the matrix.
-    T* elements;     ///< Pointer to the matrix elements.
+    size_t rows = 0;          ///< Number of rows in the matrix.
+    size_t columns = 0;       ///< Number of columns in the matrix.
+    T* elements = nullptr;    ///< Pointer to the matrix elements.
 
 public:
     // Default constructor
@@ -40,6 +41,12 @@ public:
     /// @param elements Pointer to an array of elements to initialize the matrix.
     Matrix(size_t rows, size_t columns, T* elements);
 
+    // The elements are owned, a matrix can be moved but not copied
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+    Matrix(Matrix&& other) noexcept;
+    Matrix& operator=(Matrix&& other) noexcept;
+
     // Virtual destructor
     ~Matrix() override;
 
@@ -97,6 +104,26 @@ Matrix<T>::Matrix(size_t rows, size_t columns, T* elements)
 {
 }
 
+template <Comparable T>
+Matrix<T>::Matrix(Matrix&& other) noexcept
+    : IToString(), rows(other.rows), columns(other.columns), elements(other.elements)
+{
+    other.rows = other.columns = 0;
+    other.elements = nullptr;
+}
+
+template <Comparable T>
+Matrix<T>& Matrix<T>::operator=(Matrix&& other) noexcept
+{
+    if (this != &other) {
+        delete[] elements;
+        rows = std::exchange(other.rows, 0);
+        columns = std::exchange(other.columns, 0);
+        elements = std::exchange(other.elements, nullptr);
+    }
+    return *this;
+}
+
 template <Comparable T>
 Matrix<T>::~Matrix()
 {
@@ -0,0 +1,446 @@
+#include "MatrixParser.h"
+#include "Trace.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    /// Below this size a single thread parses faster than a pool starts.
+    const size_t PARALLEL_BYTES = size_t(1) << 20;
+
+    inline bool isSpace(const char c) { return (unsigned char)c <= ' '; }
+    inline bool isDigit(const char c) { return (unsigned char)(c - '0') < 10; }
+    inline bool isSign(const char c) { return c == '-' || c == '+'; }
+
+    /// Numbers of a chunk and whether every byte of it may appear in the format.
+    struct Census
+    {
+        size_t numbers = 0;
+        bool valid = true;
+    };
+
+    /// Counts the numbers of a chunk, i.e. the non-space bytes following a space.
+    /// The chunk starts right after a space (or at the start of the matrix).
+    Census count(const char* p, const char* const end)
+    {
+        Census census;
+        bool afterSpace = true;
+
+#ifdef __SSE2__
+        // Bytes are compared unsigned by shifting them into the signed range.
+        const __m128i flip = _mm_set1_epi8((char)0x80);
+        const __m128i afterSpaces = _mm_set1_epi8((char)((' ' + 1) ^ 0x80));
+        const __m128i zero = _mm_set1_epi8((char)(('0' - 1) ^ 0x80));
+        const __m128i nine = _mm_set1_epi8((char)(('9' + 1) ^ 0x80));
+        const __m128i minus = _mm_set1_epi8('-');
+        const __m128i plus = _mm_set1_epi8('+');
+
+        uint32_t invalid = 0;
+        for (; end - p >= 16; p += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i flipped = _mm_xor_si128(bytes, flip);
+
+            const uint32_t spaces = _mm_movemask_epi8(_mm_cmpgt_epi8(afterSpaces, flipped));
+            const uint32_t digits = _mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpgt_epi8(flipped, zero), _mm_cmpgt_epi8(nine, flipped)));
+            const uint32_t signs = _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(bytes, minus), _mm_cmpeq_epi8(bytes, plus)));
+
+            invalid |= ~(spaces | digits | signs) & 0xFFFF;
+
+            const uint32_t starts = ~spaces & ((spaces << 1) | afterSpace) & 0xFFFF;
+            census.numbers += std::popcount(starts);
+            afterSpace = spaces >> 15;
+        }
+        census.valid = invalid == 0;
+#endif
+
+        for (; p < end; ++p) {
+            const bool s = isSpace(*p);
+            if (!s && !isDigit(*p) && !isSign(*p))
+                census.valid = false;
+            census.numbers += !s && afterSpace;
+            afterSpace = s;
+        }
+
+        return census;
+    }
+
+    /// Length of the run of digits at the start of 8 bytes, 8 if they're all digits.
+    /// A borrow or carry only runs past a byte that isn't a digit, the first one is exact.
+    inline int digitRun(const uint64_t bytes)
+    {
+        const uint64_t other = ((bytes + 0x4646464646464646) | (bytes - 0x3030303030303030)) & 0x8080808080808080;
+        return other ? std::countr_zero(other) / 8 : 8;
+    }
+
+    /// Converts up to 8 digits at the start of 8 bytes in three multiplications.
+    inline uint32_t digitValue(const uint64_t bytes, const int length)
+    {
+        // Digit values, moved up so the number ends in the top byte.
+        uint64_t v = (bytes - 0x3030303030303030) << (8 * (8 - length));
+        v = v * 10 + (v >> 8);
+        v = (((v & 0x000000FF000000FF) * (100 + (1000000ull << 32))) +
+             (((v >> 16) & 0x000000FF000000FF) * (1 + (10000ull << 32)))) >> 32;
+        return (uint32_t)v;
+    }
+
+    /// Parses the number at the cursor digit by digit, moving the cursor past it.
+    /// @return `false` if it's malformed or out of range.
+    bool parseNumber(const char*& p, const char* const end, int& out)
+    {
+        const bool negative = *p == '-';
+        if (isSign(*p))
+            ++p;
+
+        const char* const digits = p;
+        int64_t value = 0;
+        while (p < end && isDigit(*p)) {
+            value = value * 10 + (*p - '0');
+            if (value > (int64_t)INT_MAX + 1)
+                return false;
+            ++p;
+        }
+        if (p == digits || (p < end && !isSpace(*p)))
+            return false;
+
+        value = negative ? -value : value;
+        if (value > INT_MAX)
+            return false;
+
+        out = (int)value;
+        return true;
+    }
+
+    /// Stores every number into the matrix, row by row.
+    struct MatrixSink
+    {
+        int* out;
+
+        bool Wanted() const { return true; }
+        void Skip() {}
+        void Store(const int value) { *out++ = value; }
+    };
+
+    /// Keeps the non-zero numbers above the diagonal as edges, the rest is skipped unparsed.
+    struct EdgeSink
+    {
+        size_t vertexCount, row, column;
+        Vector<Edge> edges;
+
+        bool Wanted() const { return column > row; }
+        void Skip() { next(); }
+
+        void Store(const int value)
+        {
+            if (value != 0)
+                edges.EmplaceBack((int)row, (int)column, value);
+            next();
+        }
+
+        void next()
+        {
+            if (++column == vertexCount) {
+                column = 0;
+                row++;
+            }
+        }
+    };
+
+    /// Moves the cursor past the number at it.
+    inline void skipNumber(const char*& p, const char* const end)
+    {
+        while (p < end && !isSpace(*p))
+            ++p;
+    }
+
+    /// Parses the numbers of a chunk into a sink, at most `room` of them.
+    /// @return `false` if a number is malformed or out of range.
+    template <typename Sink>
+    bool parse(const char* p, const char* const end, size_t room, Sink& sink)
+    {
+        // Away from the end a number of up to 7 digits is converted from a single 8-byte load.
+        for (; room && end - p > 16; --room) {
+            while (isSpace(*p) && end - p > 16)
+                ++p;
+            if (isSpace(*p))
+                break;
+
+            if (!sink.Wanted()) {
+                skipNumber(p, end);
+                sink.Skip();
+                continue;
+            }
+
+            const char* const start = p;
+            const bool negative = *p == '-';
+            if (isSign(*p))
+                ++p;
+
+            uint64_t bytes;
+            memcpy(&bytes, p, sizeof(bytes));
+            const int length = digitRun(bytes);
+
+            if (length == 0 || length == 8 || !isSpace(p[length])) {
+                p = start;
+                int value;
+                if (!parseNumber(p, end, value))
+                    return false;
+                sink.Store(value);
+                continue;
+            }
+
+            const int value = (int)digitValue(bytes, length);
+            sink.Store(negative ? -value : value);
+            p += length;
+        }
+
+        for (; room; --room) {
+            while (p < end && isSpace(*p))
+                ++p;
+            if (p == end)
+                return true;
+
+            if (!sink.Wanted()) {
+                skipNumber(p, end);
+                sink.Skip();
+                continue;
+            }
+
+            int value;
+            if (!parseNumber(p, end, value))
+                return false;
+            sink.Store(value);
+        }
+        return true;
+    }
+
+    /// The vertex count and the chunks of the numbers after it.
+    struct Layout
+    {
+        size_t vertexCount = 0;
+        size_t wanted = 0;                ///< Numbers of the matrix.
+        size_t threads = 1;
+        std::vector<const char*> bounds;  ///< Start of every chunk, and the end of the text.
+        std::vector<size_t> offsets;      ///< Index of the first number of every chunk, and the count.
+
+        size_t ChunkCount() const { return offsets.size() - 1; }
+
+        /// Numbers of a chunk that are part of the matrix.
+        size_t Room(const size_t chunk) const
+        {
+            return offsets[chunk] >= wanted ? 0 : std::min(offsets[chunk + 1], wanted) - offsets[chunk];
+        }
+    };
+
+    /// Reads the vertex count, cuts the rest into chunks and counts their numbers.
+    /// @throws std::runtime_error if a byte can't be in the format or numbers are missing.
+    Layout lay(const char* text, const size_t length, const size_t threads)
+    {
+        Layout layout;
+        const char* p = text;
+        const char* const end = text + length;
+
+        // The vertex count, an empty text is an empty matrix.
+        while (p < end && isSpace(*p))
+            ++p;
+        if (p < end && *p == '+')
+            ++p;
+        const char* const countDigits = p;
+        while (p < end && isDigit(*p)) {
+            layout.vertexCount = layout.vertexCount * 10 + (*p++ - '0');
+            if (layout.vertexCount > (size_t)1 << 24)
+                throw std::runtime_error("The vertex count is too large");
+        }
+        if (p < end && !isSpace(*p))
+            throw std::runtime_error("Malformed vertex count");
+        if (p == countDigits && p < end)
+            throw std::runtime_error("Malformed vertex count");
+
+        layout.wanted = layout.vertexCount * layout.vertexCount;
+        if (layout.wanted == 0) {
+            layout.bounds.assign(2, end);
+            layout.offsets.assign(2, 0);
+            return layout;
+        }
+
+        // Chunks end on a space, so a number never straddles two of them.
+        const size_t body = end - p;
+        layout.threads = body < PARALLEL_BYTES ? 1 : WorkStealingPool::Threads(threads, body / PARALLEL_BYTES);
+        const size_t chunkCount = layout.threads == 1 ? 1 : layout.threads * 4;
+
+        std::vector<const char*>& bounds = layout.bounds;
+        bounds.assign(chunkCount + 1, end);
+        bounds[0] = p;
+        for (size_t i = 1; i < chunkCount; ++i) {
+            const char* b = std::max(bounds[i - 1], p + body / chunkCount * i);
+            while (b < end && !isSpace(*b))
+                ++b;
+            bounds[i] = b;
+        }
+
+        std::vector<Census> census(chunkCount);
+        WorkStealingPool::Run(chunkCount, layout.threads, [&](size_t, const size_t chunk) {
+            census[chunk] = count(bounds[chunk], bounds[chunk + 1]);
+        });
+
+        layout.offsets.assign(chunkCount + 1, 0);
+        for (size_t i = 0; i < chunkCount; ++i) {
+            if (!census[i].valid)
+                throw std::runtime_error("Unexpected character in the matrix");
+            layout.offsets[i + 1] = layout.offsets[i] + census[i].numbers;
+        }
+        if (layout.offsets[chunkCount] < layout.wanted)
+            throw std::runtime_error("Expected " + std::to_string(layout.wanted) + " weights, found " +
+                                     std::to_string(layout.offsets[chunkCount]));
+
+        return layout;
+    }
+
+    /// Maps a file into memory for the duration of a call.
+    template <typename Result, typename Read>
+    Result mapFile(const std::string& path, const Read& read)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Can't open '" + path + "'");
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            close(fd);
+            throw std::runtime_error("Can't read '" + path + "'");
+        }
+
+        if (info.st_size == 0) {
+            close(fd);
+            return read(nullptr, 0);
+        }
+
+        void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("Can't map '" + path + "'");
+        madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+        try {
+            Result result = read(static_cast<const char*>(mapped), info.st_size);
+            munmap(mapped, info.st_size);
+            return result;
+        } catch (...) {
+            munmap(mapped, info.st_size);
+            throw;
+        }
+    }
+}
+
+Matrix<int> MatrixParser::Parse(const char* text, size_t length, size_t threads)
+{
+    TraceScope span("parse");
+
+    const Layout layout = lay(text, length, threads);
+    auto elements = std::make_unique_for_overwrite<int[]>(layout.wanted);
+    if (layout.wanted == 0)
+        return Matrix<int>(layout.vertexCount, layout.vertexCount, elements.release());
+
+    // Numbers after the matrix are ignored, as the stream reader did.
+    std::vector<char> failed(layout.ChunkCount(), 0);
+    WorkStealingPool::Run(layout.ChunkCount(), layout.threads, [&](size_t, const size_t chunk) {
+        MatrixSink sink{ elements.get() + layout.offsets[chunk] };
+        failed[chunk] = !parse(layout.bounds[chunk], layout.bounds[chunk + 1], layout.Room(chunk), sink);
+    });
+
+    if (std::ranges::any_of(failed, [](const char f) { return f != 0; }))
+        throw std::runtime_error("Malformed weight in the matrix");
+
+    return Matrix<int>(layout.vertexCount, layout.vertexCount, elements.release());
+}
+
+MatrixParser::EdgeList MatrixParser::ParseEdges(const char* text, size_t length, size_t threads)
+{
+    TraceScope span("parse");
+
+    const Layout layout = lay(text, length, threads);
+    const size_t n = layout.vertexCount;
+
+    std::vector<EdgeSink> sinks;
+    sinks.reserve(layout.ChunkCount());
+    for (size_t i = 0; i < layout.ChunkCount(); ++i)
+        sinks.push_back(EdgeSink{ n, n ? layout.offsets[i] / n : 0, n ? layout.offsets[i] % n : 0, Vector<Edge>() });
+
+    std::vector<char> failed(layout.ChunkCount(), 0);
+    WorkStealingPool::Run(layout.ChunkCount(), layout.threads, [&](size_t, const size_t chunk) {
+        failed[chunk] = !parse(layout.bounds[chunk], layout.bounds[chunk + 1], layout.Room(chunk), sinks[chunk]);
+    });
+
+    if (std::ranges::any_of(failed, [](const char f) { return f != 0; }))
+        throw std::runtime_error("Malformed weight in the matrix");
+
+    // The chunks are in the matrix order, so are their edges one after another.
+    size_t edgeCount = 0;
+    for (const EdgeSink& sink : sinks)
+        edgeCount += sink.edges.Size();
+
+    EdgeList list{ n, Vector<Edge>(edgeCount) };
+    for (EdgeSink& sink : sinks) {
+        for (const Edge& e : sink.edges)
+            list.edges.PushBack(e);
+        sink.edges = Vector<Edge>();
+    }
+    return list;
+}
+
+Graph MatrixParser::ParseGraph(const char* text, size_t length, size_t threads)
+{
+    return BuildGraph(ParseEdges(text, length, threads));
+}
+
+Graph MatrixParser::BuildGraph(EdgeList&& list)
+{
+    std::sort(list.edges.begin(), list.edges.end(), [](Edge& l, Edge& r) { return l.Less(r); });
+    return Graph(list.vertexCount, std::move(list.edges));
+}
+
+Matrix<int> MatrixParser::ReadFile(const std::string& path, size_t threads)
+{
+    return mapFile<Matrix<int>>(path, [threads](const char* text, const size_t length) {
+        return Parse(text, length, threads);
+    });
+}
+
+MatrixParser::EdgeList MatrixParser::ReadEdges(const std::string& path, size_t threads)
+{
+    return mapFile<EdgeList>(path, [threads](const char* text, const size_t length) {
+        return ParseEdges(text, length, threads);
+    });
+}
+
+Graph MatrixParser::ReadGraph(const std::string& path, size_t threads)
+{
+    return mapFile<Graph>(path, [threads](const char* text, const size_t length) {
+        return ParseGraph(text, length, threads);
+    });
+}
+
+Matrix<int> MatrixParser::Read(std::istream& input, size_t threads)
+{
+    const std::string text(std::istreambuf_iterator<char>(input), {});
+    return Parse(text.data(), text.size(), threads);
+}
@@ -0,0 +1,92 @@
+#ifndef __MATRIX_PARSER_H
+#define __MATRIX_PARSER_H
+
+#include "Edge.h"
+#include "Graph.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+/// @brief Parses adjacency matrices in the text input format at memory speed.
+///
+/// The format is the vertex count followed by the matrix, row by row, all
+/// of them integers separated by any whitespace. The file is mapped into
+/// memory and the text after the vertex count is cut into chunks on
+/// whitespace, so no number straddles two of them. A first pass counts the
+/// numbers of every chunk, classifying 16 bytes at a time with SSE2, and
+/// rejects any byte that can't be part of the format. The counts tell every
+/// chunk where its numbers go, and a second pass parses the chunks straight
+/// into the matrix, converting short numbers from a single 8-byte load. Both
+/// passes run on a WorkStealingPool.
+///
+/// A graph needs only the upper triangle, so it can be read as edges
+/// instead: the numbers on and below the diagonal are skipped unparsed and
+/// the non-zero ones above it go straight into per-chunk edge lists. The
+/// dense matrix is never allocated, a sparse graph takes the memory of its
+/// edges.
+class MatrixParser
+{
+public:
+    /// @brief The edges of an adjacency matrix.
+    struct EdgeList
+    {
+        size_t vertexCount = 0;
+        Vector<Edge> edges;  ///< The non-zero entries above the diagonal, row by row.
+    };
+
+    /// @brief Parses a matrix held in memory.
+    /// @param text The input text.
+    /// @param length Bytes of the text.
+    /// @param threads Workers, 0 picks the hardware concurrency. Small inputs use one.
+    /// @return The matrix, 0 by 0 for an empty text.
+    /// @throws std::runtime_error if the text is malformed or has fewer numbers than the matrix.
+    [[nodiscard]]
+    static Matrix<int> Parse(const char* text, size_t length, size_t threads = 0);
+
+    /// @brief Parses a matrix file, mapped into memory.
+    /// @param path The input file.
+    /// @param threads Workers, 0 picks the hardware concurrency.
+    /// @throws std::runtime_error if the file can't be read or is malformed.
+    [[nodiscard]]
+    static Matrix<int> ReadFile(const std::string& path, size_t threads = 0);
+
+    /// @brief Parses the edges of a matrix held in memory, see Parse.
+    /// @return The edges in the matrix order.
+    /// @throws std::runtime_error if the text is malformed or has fewer numbers than the matrix.
+    [[nodiscard]]
+    static EdgeList ParseEdges(const char* text, size_t length, size_t threads = 0);
+
+    /// @brief Parses the graph of a matrix held in memory, see Parse.
+    /// @return The graph, its edges sorted by their weights as Graph(const Matrix<int>&) does.
+    /// @throws std::runtime_error if the text is malformed or has fewer numbers than the matrix.
+    [[nodiscard]]
+    static Graph ParseGraph(const char* text, size_t length, size_t threads = 0);
+
+    /// @brief Sorts the edges of a matrix into its graph.
+    /// @param list The edges, taken over.
+    /// @return The graph, its edges sorted by their weights as Graph(const Matrix<int>&) does.
+    [[nodiscard]]
+    static Graph BuildGraph(EdgeList&& list);
+
+    /// @brief Parses the edges of a matrix file, mapped into memory.
+    /// @throws std::runtime_error if the file can't be read or is malformed.
+    [[nodiscard]]
+    static EdgeList ReadEdges(const std::string& path, size_t threads = 0);
+
+    /// @brief Parses the graph of a matrix file, mapped into memory.
+    /// @throws std::runtime_error if the file can't be read or is malformed.
+    [[nodiscard]]
+    static Graph ReadGraph(const std::string& path, size_t threads = 0);
+
+    /// @brief Parses what's left of a stream, read in one block.
+    /// @param input The input stream.
+    /// @param threads Workers, 0 picks the hardware concurrency.
+    /// @throws std::runtime_error if the text is malformed.
+    [[nodiscard]]
+    static Matrix<int> Read(std::istream& input, size_t threads = 0);
+};
+
+#endif // __MATRIX_PARSER_H
@@ -0,0 +1,328 @@
+#include "MicroBenchmark.h"
+#include "BinaryHeap.h"
+#include "DensePrim.h"
+#include "DisjointSet.h"
+#include "Graph.h"
+#include "GraphGenerator.h"
+#include "Matrix.h"
+#include "SpanningTreesFinder.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <queue>
+#include <random>
+#include <string>
+
+/// Results of the bodies end up here, so the compiler can't drop them.
+static volatile uint64_t sink;
+
+MicroBenchmark::Result MicroBenchmark::Measure(
+    const std::string& name, size_t operations, const std::function<void()>& body, const Options& options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    for (size_t i = 0; i < options.warmup; ++i)
+        body();
+
+    std::vector<double> samples;
+    for (size_t i = 0; i < std::max<size_t>(options.repetitions, 1); ++i) {
+        const auto start = Clock::now();
+        body();
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        samples.push_back(elapsed.count() / std::max<size_t>(operations, 1));
+    }
+
+    std::ranges::sort(samples);
+
+    // Nearest-rank percentiles.
+    auto percentile = [&samples](double p) {
+        const size_t rank = (size_t)(p * (samples.size() - 1) + 0.5);
+        return samples[rank];
+    };
+
+    Result result;
+    result.name = name;
+    result.operations = operations;
+    result.median = percentile(0.5);
+    result.p10 = percentile(0.1);
+    result.p90 = percentile(0.9);
+    result.min = samples.front();
+    result.max = samples.back();
+    return result;
+}
+
+/// Union-find with the sizes kept as negative parents of the roots and
+/// path halving, the layout to compare DisjointSet against.
+class CompactDisjointSet
+{
+    std::vector<int> parents;
+    size_t components = 0;
+
+public:
+    explicit CompactDisjointSet(size_t count) : parents(count, -1), components(count) {}
+
+    void Reset()
+    {
+        std::ranges::fill(parents, -1);
+        components = parents.size();
+    }
+
+    int Find(int x)
+    {
+        while (parents[x] >= 0) {
+            if (parents[parents[x]] >= 0)
+                parents[x] = parents[parents[x]];
+            x = parents[x];
+        }
+        return x;
+    }
+
+    bool Unify(int x, int y)
+    {
+        x = Find(x);
+        y = Find(y);
+        if (x == y)
+            return false;
+        if (parents[x] > parents[y])
+            std::swap(x, y);
+        parents[x] += parents[y];
+        parents[y] = x;
+        components--;
+        return true;
+    }
+
+    size_t Components() const { return components; }
+};
+
+/// Pushes children costs not cheaper than the polled one, like the search does.
+template <typename Push, typename Pop>
+static uint64_t pushPopMix(size_t polls, Push push, Pop pop)
+{
+    std::mt19937 rng(1);
+    uint64_t sum = 0;
+
+    push(0);
+    for (size_t i = 0; i < polls; ++i) {
+        const int cost = pop();
+        sum += cost;
+        for (int c = 1 + rng() % 3; c > 0; --c)
+            push(cost + (int)(rng() % 64));
+    }
+    return sum;
+}
+
+std::vector<MicroBenchmark::Result> MicroBenchmark::RunAll(const Options& options)
+{
+    std::vector<Result> results;
+
+    auto run = [&](const std::string& name, size_t operations, const std::function<void()>& body) {
+        if (name.find(options.filter) != std::string::npos)
+            results.push_back(Measure(name, operations, body, options));
+    };
+
+    // Heaps, a poll followed by 1-3 pushes, the heap grows over the run.
+    const size_t POLLS = 4096;
+
+    run("heap/push-pop/BinaryHeap", POLLS, [&] {
+        BinaryHeap<int> heap;
+        sink = pushPopMix(POLLS, [&](int c) { heap.Insert(c); }, [&] { return heap.Poll(); });
+    });
+
+    run("heap/push-pop/std::priority_queue", POLLS, [&] {
+        std::priority_queue<int, std::vector<int>, std::greater<int>> heap;
+        sink = pushPopMix(POLLS, [&](int c) { heap.push(c); },
+            [&] { const int top = heap.top(); heap.pop(); return top; });
+    });
+
+    // Union-find, Kruskal over the sorted edges of a sparse graph with a
+    // few edges forced first, like CreatePartition on a search space.
+    const Graph graph(GraphGenerator::Generate(GraphGenerator::SPARSE_RANDOM, 500, 1));
+    const size_t TREES = 64;
+
+    std::vector<std::pair<int, int>> edges;
+    for (const Edge& e : graph.Edges())
+        edges.emplace_back(e.nodeX, e.nodeY);
+
+    run("dsu/kruskal/DisjointSet", TREES * edges.size(), [&] {
+        DisjointSet<int> ds(graph.VertexCount());
+        uint64_t added = 0;
+        for (size_t t = 0; t < TREES; ++t) {
+            ds.Reset();
+            for (size_t i = t; i < edges.size(); i += 16)
+                ds.Unify(edges[i].first, edges[i].second);
+            for (size_t i = 0; i < edges.size() && ds.numberOfComponents > 1; ++i) {
+                if (!ds.NodesConnected(edges[i].first, edges[i].second)) {
+                    ds.Unify(edges[i].first, edges[i].second);
+                    added++;
+                }
+            }
+        }
+        sink = added;
+    });
+
+    run("dsu/kruskal/compact+halving", TREES * edges.size(), [&] {
+        CompactDisjointSet ds(graph.VertexCount());
+        uint64_t added = 0;
+        for (size_t t = 0; t < TREES; ++t) {
+            ds.Reset();
+            for (size_t i = t; i < edges.size(); i += 16)
+                ds.Unify(edges[i].first, edges[i].second);
+            for (size_t i = 0; i < edges.size() && ds.Components() > 1; ++i)
+                added += ds.Unify(edges[i].first, edges[i].second);
+        }
+        sink = added;
+    });
+
+    // Trees of search spaces, Kruskal's over the sorted edges against Prim's
+    // over the adjacency matrix. The spaces are those of the first trees of
+    // a search, complete graphs of growing size and a complete graph thinned
+    // out locate where DensePrim::Faster should switch.
+    auto mst = [&](const std::string& name, const Graph& g) {
+        std::vector<Partition::Choices> spaces;
+        SolveOptions solveOptions;
+        solveOptions.treeLimit = 256;
+        solveOptions.kernel = SolveOptions::KRUSKAL;
+        SpanningTreesFinder::Solve(g, [&spaces](const Partition& p) {
+            spaces.push_back(p.choices);
+            return true;
+        }, solveOptions);
+
+        run("mst/" + name + "/Kruskal", spaces.size(), [&] {
+            DisjointSet<int> ds(g.VertexCount());
+            uint64_t cost = 0;
+            for (const Partition::Choices& choices : spaces) {
+                const Partition* p = SpanningTreesFinder::CreatePartition(choices, g, ds);
+                cost += p->mstCost;
+                delete p;
+            }
+            sink = cost;
+        });
+
+        run("mst/" + name + "/Prim", spaces.size(), [&] {
+            DensePrim prim(g);
+            uint64_t cost = 0;
+            for (const Partition::Choices& choices : spaces) {
+                const Partition* p = prim.CreatePartition(choices);
+                cost += p->mstCost;
+                delete p;
+            }
+            sink = cost;
+        });
+    };
+
+    for (const size_t n : { 16, 32, 64, 128, 256 })
+        mst("complete-" + std::to_string(n), Graph(GraphGenerator::Generate(GraphGenerator::COMPLETE, n, 1)));
+
+    const Graph complete(GraphGenerator::Generate(GraphGenerator::COMPLETE, 128, 1));
+    for (const int percent : { 50, 25, 10 }) {
+        std::mt19937 rng(percent);
+        Vector<Edge> kept;
+        for (const Edge& e : complete.Edges())
+            if ((int)(rng() % 100) < percent)
+                kept.PushBack(e);
+        mst("density-" + std::to_string(percent) + "/128", Graph(128, kept));
+    }
+
+    // Copies of a choice vector, one per child of an expanded partition.
+    const size_t CHOICES = 435, COPIES = 4096;
+
+    run("vector/copy/Vector<int>", COPIES, [&] {
+        const Vector<int> choices(CHOICES, 0);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < COPIES; ++i) {
+            Vector<int> copy(choices);
+            copy[i % CHOICES] = -1;
+            sum += copy[(i * 7) % CHOICES];
+        }
+        sink = sum;
+    });
+
+    run("vector/copy/std::vector<int>", COPIES, [&] {
+        const std::vector<int> choices(CHOICES, 0);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < COPIES; ++i) {
+            std::vector<int> copy(choices);
+            copy[i % CHOICES] = -1;
+            sum += copy[(i * 7) % CHOICES];
+        }
+        sink = sum;
+    });
+
+    run("vector/push-back/Vector<int>", COPIES * 16, [&] {
+        Vector<int> v;
+        for (size_t i = 0; i < COPIES * 16; ++i)
+            v.PushBack((int)i);
+        sink = v.Size();
+    });
+
+    run("vector/push-back/std::vector<int>", COPIES * 16, [&] {
+        std::vector<int> v;
+        for (size_t i = 0; i < COPIES * 16; ++i)
+            v.push_back((int)i);
+        sink = v.size();
+    });
+
+    // Bulk reads of an adjacency matrix, the way the edges are extracted.
+    const size_t SIDE = 512;
+    const Matrix<int> adjMat = GraphGenerator::Generate(GraphGenerator::COMPLETE, SIDE, 1);
+    const std::vector<int> flat(adjMat.Elements(), adjMat.Elements() + SIDE * SIDE);
+
+    run("matrix/read/Matrix::Get", SIDE * SIDE, [&] {
+        uint64_t sum = 0;
+        for (size_t r = 0; r < SIDE; ++r)
+            for (size_t c = 0; c < SIDE; ++c)
+                sum += adjMat.Get(r, c);
+        sink = sum;
+    });
+
+    run("matrix/read/Matrix::Elements", SIDE * SIDE, [&] {
+        uint64_t sum = 0;
+        const int* elems = adjMat.Elements();
+        for (size_t i = 0; i < SIDE * SIDE; ++i)
+            sum += elems[i];
+        sink = sum;
+    });
+
+    run("matrix/read/std::vector<int>", SIDE * SIDE, [&] {
+        uint64_t sum = 0;
+        for (size_t r = 0; r < SIDE; ++r)
+            for (size_t c = 0; c < SIDE; ++c)
+                sum += flat[r * SIDE + c];
+        sink = sum;
+    });
+
+    return results;
+}
+
+void MicroBenchmark::Print(std::ostream& os, const std::vector<Result>& results)
+{
+    os << std::left << std::setw(40) << "case" << std::right
+       << std::setw(12) << "median ns" << std::setw(12) << "p10"
+       << std::setw(12) << "p90" << std::setw(12) << "min" << std::setw(12) << "max" << "\n";
+
+    for (const Result& r : results) {
+        os << std::left << std::setw(40) << r.name << std::right << std::fixed << std::setprecision(2)
+           << std::setw(12) << r.median << std::setw(12) << r.p10
+           << std::setw(12) << r.p90 << std::setw(12) << r.min << std::setw(12) << r.max << "\n";
+    }
+
+    os << std::defaultfloat;
+}
+
+void MicroBenchmark::WriteJson(std::ostream& os, const std::vector<Result>& results)
+{
+    os << "{\n  \"unit\": \"ns/op\",\n  \"cases\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << (i ? ",\n" : "\n")
+           << "    { \"name\": \"" << r.name << "\", \"operations\": " << r.operations
+           << ", \"median\": " << r.median << ", \"p10\": " << r.p10 << ", \"p90\": " << r.p90
+           << ", \"min\": " << r.min << ", \"max\": " << r.max << " }";
+    }
+
+    os << "\n  ]\n}\n";
+}
@@ -0,0 +1,65 @@
+#ifndef __MICRO_BENCHMARK_H
+#define __MICRO_BENCHMARK_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief Compares the containers of the solver with their standard counterparts.
+///
+/// Every case runs its body a few times to warm up the caches and the
+/// allocator, then measures a number of repetitions. The spread of the
+/// repetitions is reported as the median and percentiles of the time per
+/// operation, which are far less sensitive to a noisy machine than a mean.
+class MicroBenchmark
+{
+public:
+    /// @brief How the cases are run.
+    struct Options
+    {
+        size_t warmup = 3;       ///< Unmeasured runs of every case.
+        size_t repetitions = 15; ///< Measured runs of every case.
+        std::string filter;      ///< Only cases whose name contains it, empty for all.
+    };
+
+    /// @brief Time per operation of a case over its repetitions, in nanoseconds.
+    struct Result
+    {
+        std::string name;
+        size_t operations = 0; ///< Operations done by one run of the body.
+        double median = 0;
+        double p10 = 0;
+        double p90 = 0;
+        double min = 0;
+        double max = 0;
+    };
+
+    /// @brief Measures a single case.
+    /// @param name Name of the case, `group/workload/implementation`.
+    /// @param operations Operations done by one run of the body.
+    /// @param body The measured code.
+    /// @param options Warmup and repetitions.
+    [[nodiscard]]
+    static Result Measure(
+        const std::string& name,
+        size_t operations,
+        const std::function<void()>& body,
+        const Options& options
+    );
+
+    /// @brief Runs the built-in cases: heap push/pop mixes, union/find over
+    /// Kruskal-like edge sequences, the two MST kernels over search spaces,
+    /// copies of choice vectors and matrix reads.
+    [[nodiscard]]
+    static std::vector<Result> RunAll(const Options& options);
+
+    /// @brief Prints the results as a table.
+    static void Print(std::ostream& os, const std::vector<Result>& results);
+
+    /// @brief Writes the results as a JSON document.
+    static void WriteJson(std::ostream& os, const std::vector<Result>& results);
+};
+
+#endif // __MICRO_BENCHMARK_H
@@ -0,0 +1,41 @@
+#include "OutputBuffer.h"
+#include "Trace.h"
+
+#include <cstring>
+
+OutputBuffer::OutputBuffer(FILE* file, size_t capacity)
+: file(file), buffer(new char[capacity]), capacity(capacity)
+{}
+
+OutputBuffer::~OutputBuffer()
+{
+    Flush();
+}
+
+void OutputBuffer::Flush()
+{
+    if (used == 0)
+        return;
+
+    TraceScope span("output.flush");
+
+    fwrite(buffer.get(), 1, used, file);
+    fflush(file);
+    used = 0;
+}
+
+OutputBuffer& OutputBuffer::operator << (std::string_view text)
+{
+    // Text bigger than the whole buffer goes straight through.
+    if (text.size() > capacity - used) {
+        Flush();
+        if (text.size() > capacity) {
+            fwrite(text.data(), 1, text.size(), file);
+            return *this;
+        }
+    }
+
+    memcpy(buffer.get() + used, text.data(), text.size());
+    used += text.size();
+    return *this;
+}
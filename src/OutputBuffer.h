@@ -0,0 +1,64 @@
+#ifndef __OUTPUT_BUFFER_H
+#define __OUTPUT_BUFFER_H
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+/// @brief A large reusable output buffer for bulk text output.
+///
+/// Text is appended straight into the buffer, numbers are formatted with
+/// `std::to_chars`, and the buffer goes to the file in big blocks with a
+/// single `fwrite` whenever it fills up. There are no per-call stream
+/// sentries, locales or temporary strings on the way.
+class OutputBuffer
+{
+public:
+    /// @brief Constructs a buffer writing to the given file.
+    /// @param file The file to write to (e.g. `stdout`), not owned.
+    /// @param capacity Size of the buffer in bytes.
+    explicit OutputBuffer(FILE* file, size_t capacity = 1 << 20);
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    /// @brief Flushes whatever is left in the buffer.
+    ~OutputBuffer();
+
+    /// @brief Writes the buffered text to the file.
+    void Flush();
+
+    /// @brief Appends a piece of text.
+    OutputBuffer& operator << (std::string_view text);
+
+    /// @brief Appends a single character.
+    OutputBuffer& operator << (char c)
+    {
+        if (used == capacity)
+            Flush();
+        buffer[used++] = c;
+        return *this;
+    }
+
+    /// @brief Appends an integer in decimal.
+    template <std::integral T>
+    OutputBuffer& operator << (T value)
+    {
+        // 20 digits and a sign cover any 64-bit integer.
+        if (capacity - used < 24)
+            Flush();
+        used = std::to_chars(buffer.get() + used, buffer.get() + capacity, value).ptr - buffer.get();
+        return *this;
+    }
+
+private:
+    FILE* file;
+    std::unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used = 0;
+};
+
+#endif // __OUTPUT_BUFFER_H
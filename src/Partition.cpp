@@ -1,27 +1,34 @@
 #include "Partition.h"
+#include <cstdint>
 #include <sstream>
 
 Partition::Partition(Partition&& other) noexcept 
     : mstCost(other.mstCost), 
       choices(std::move(other.choices)), 
-      mstEdges(std::move(other.mstEdges)) {}
+      mstEdges(std::move(other.mstEdges)),
+      parent(other.parent),
+      branch(std::move(other.branch)),
+      ghost(other.ghost) {}
 
 Partition& Partition::operator=(Partition&& other) noexcept {
     if (this != &other) {
         mstCost = other.mstCost;
         choices = std::move(other.choices);
         mstEdges = std::move(other.mstEdges);
+        parent = other.parent;
+        branch = std::move(other.branch);
+        ghost = other.ghost;
     }
     return *this;
 }
 
-Partition::Partition(Vector<int> ch, int cost, Vector<int> edges)
+Partition::Partition(Choices ch, int cost, Vector<int> edges)
 : mstCost(cost), choices(ch), mstEdges(edges) 
 {}
 
 Partition::Partition(size_t edgeCount)
 : mstCost(0), 
-    choices(Vector<int>(edgeCount)), 
+    choices(Choices(edgeCount)), 
     mstEdges(Vector<int>(edgeCount))
 {}
 
@@ -29,6 +36,63 @@ void Partition::Reset() {
     this->choices.Clear();
     this->mstCost = 0;
     this->mstEdges.Clear();
+    this->parent = -1;
+    this->branch.reset();
+    this->ghost = false;
+}
+
+void Partition::Serialize(std::ostream& os) const {
+    int32_t depth = 0;
+    for (const Branch* b = branch.get(); b != nullptr; b = b->parent.get())
+        depth++;
+
+    const int32_t header[6] = {
+        mstCost, parent, ghost, depth, (int32_t)choices.Size(), (int32_t)mstEdges.Size()
+    };
+    os.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    // The chain goes from the space up to the MST.
+    for (const Branch* b = branch.get(); b != nullptr; b = b->parent.get()) {
+        const int32_t edge = b->edge;
+        os.write(reinterpret_cast<const char*>(&edge), sizeof(edge));
+    }
+
+    for (const int c : choices)
+        os.put((char)c);
+
+    for (const int e : mstEdges) {
+        const int32_t index = e;
+        os.write(reinterpret_cast<const char*>(&index), sizeof(index));
+    }
+}
+
+bool Partition::Deserialize(std::istream& is) {
+    int32_t header[6];
+    if (!is.read(reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+
+    Reset();
+    mstCost = header[0];
+    parent = header[1];
+    ghost = header[2];
+
+    // Rebuilt from the MST down, the links aren't shared anymore.
+    Vector<int32_t> edges(header[3], 0);
+    if (header[3] > 0)
+        is.read(reinterpret_cast<char*>(edges.begin()), header[3] * sizeof(int32_t));
+    for (int32_t i = header[3] - 1; i >= 0; --i)
+        branch = std::make_shared<const Branch>(edges[i], branch);
+
+    for (int32_t i = 0; i < header[4]; ++i)
+        choices.PushBack((EdgeChoice)(signed char)is.get());
+
+    for (int32_t i = 0; i < header[5]; ++i) {
+        int32_t index;
+        is.read(reinterpret_cast<char*>(&index), sizeof(index));
+        mstEdges.PushBack(index);
+    }
+
+    return (bool)is;
 }
 
 std::string 
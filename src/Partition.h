@@ -5,29 +5,50 @@
 #include "IToString.h"
 #include "Graph.h"
 #include "Vector.h"
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <iostream>
+#include <istream>
+#include <memory>
+
+/// @brief A link in the chain of edges excluded on the way from the MST to a search space.
+///
+/// Every search space is cut from its parent by excluding one edge of the
+/// parent's tree (and including the tree edges before it), so the chain
+/// of these edges is enough to rebuild the choices of any search space.
+/// Links are shared by all the spaces cut from the same parent.
+struct Branch
+{
+    int edge;                              ///< Edge excluded when the space was cut
+    std::shared_ptr<const Branch> parent;  ///< Branch of the parent space, null for the MST
+};
 
 /// @brief Represents a partition of edges in a graph.
 struct Partition : public IComparable<Partition>, public IToString
 {
 public:
-    enum EdgeChoice {
+    /// A byte per edge, the choices are most of what a partition takes.
+    enum EdgeChoice : int8_t {
         NOT_ASSESSED = 0,
         EXCLUDED = -1,
         INCLUDED = 1,
     };
 
+    using Choices = Vector<EdgeChoice>;
+
     int mstCost;                // Cost of the found MST
-    Vector<int> choices;   // 0, 1 or -1 per edge (use the enum for all practical purposes)
+    Choices choices;       // 0, 1 or -1 per edge
     Vector<int> mstEdges;  // Indexes in the list of edges
+    int parent = -1;       // Index (in output order) of the tree this space was cut from, -1 for the MST
+    std::shared_ptr<const Branch> branch;  // How this space was cut, only tracked for bounded searches
+    bool ghost = false;    // Bound of dropped sub-spaces: their cheapest cost, the parent's branch and their excluded edges in mstEdges, see PartitionQueue
 
     /// @brief Constructor that initializes a partition with a specified edge count.
     Partition(size_t edgeCount);
 
     /// @brief Constructor that initializes a partition with given choices, cost, and edges.
-    Partition(Vector<int> ch, int cost, Vector<int> edges);
+    Partition(Choices ch, int cost, Vector<int> edges);
 
     // Copy constructors
     Partition(const Partition& p) = default;
@@ -40,6 +61,16 @@ public:
     /// @brief Resets the partition to its initial state.
     void Reset();
 
+    /// @brief Writes the partition to a binary stream.
+    /// 
+    /// The choices take a single byte per edge, the cost, parent, edge 
+    /// indices and the edges of the branch chain four bytes each.
+    void Serialize(std::ostream& os) const;
+
+    /// @brief Reads a partition written by Serialize, replacing the current content.
+    /// @return `false` if the stream ended before a whole partition was read.
+    bool Deserialize(std::istream& is);
+
     std::string ToString() const override;                    // String representation
     std::string ToString(const Graph& g) const;               // String with graph info
 
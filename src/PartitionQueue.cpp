@@ -0,0 +1,323 @@
+#include "PartitionQueue.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+std::atomic<size_t> PartitionQueue::runCounter = 0;
+
+PartitionQueue::PartitionQueue(
+    size_t memoryLimit, const std::string& spillDirectory, size_t partitionLimit)
+: memoryLimit(memoryLimit), spillDirectory(spillDirectory), partitionLimit(partitionLimit)
+{
+    if (this->spillDirectory.empty())
+        this->spillDirectory = std::filesystem::temp_directory_path().string();
+}
+
+PartitionQueue::~PartitionQueue()
+{
+    for (Partition* p : heap.HeapVec())
+        delete p;
+
+
+    for (const auto& run : runs) {
+        run->input.close();
+        std::remove(run->path.c_str());
+    }
+}
+
+size_t PartitionQueue::Footprint(const Partition& p)
+{
+    return sizeof(Partition) + p.choices.Size() * sizeof(Partition::EdgeChoice) + p.mstEdges.Size() * sizeof(int);
+}
+
+void PartitionQueue::Insert(Partition* p)
+{
+    if (p->ghost) {
+        insertBound(p->mstCost, p->parent, p->branch, p->mstEdges);
+        delete p;
+        return;
+    }
+
+    heap.Insert(p);
+    residentBytes += Footprint(*p);
+    if (droppable(*p))
+        droppableCount++;
+
+    if (partitionLimit && droppableCount > partitionLimit)
+        drop();
+
+    // Keep at least a few partitions around, spilling a handful at a time is pointless.
+    if (memoryLimit && residentBytes > memoryLimit && heap.Size() >= 16)
+        spill();
+}
+
+Partition* PartitionQueue::Poll()
+{
+    const size_t r = cheapestRun();
+    pruneBoundOrder();
+
+    // The cheapest of the heap and the runs, ties go to the heap.
+    const Partition* next = heap.Empty() ? nullptr : heap.Peek();
+    if (r < runs.size() && (next == nullptr || runs[r]->head.Less(*next)))
+        next = &runs[r]->head;
+
+    if (!boundOrder.empty() && (next == nullptr || boundOrder.top().first < next->mstCost)) {
+        auto node = bounds.extract(boundOrder.top().second);
+        boundOrder.pop();
+        return ghostOf(std::move(node.mapped()));
+    }
+
+    if (r < runs.size() && next == &runs[r]->head) {
+        Partition* p = new Partition(std::move(runs[r]->head));
+        spilledCount--;
+        advance(r);
+        return p;
+    }
+
+    Partition* p = heap.Poll();
+    residentBytes -= Footprint(*p);
+    if (droppable(*p))
+        droppableCount--;
+    return p;
+}
+
+void PartitionQueue::drop()
+{
+    std::vector<Partition*> parts = heap.HeapVec();
+
+    // The partitions that can't be cut again go first, they all stay.
+    const auto droppables = std::ranges::partition(parts, [](const Partition* p) { return !droppable(*p); });
+    const size_t fixed = droppables.begin() - parts.begin();
+
+    // Only the cheapest droppable ones need to be found, not sorted.
+    const size_t keep = std::max<size_t>(partitionLimit / 2, 1);
+    const auto kept = parts.begin() + fixed + keep;
+    std::nth_element(parts.begin() + fixed, kept, parts.end(), PartitionPtrLess());
+
+    for (auto it = kept; it != parts.end(); ++it) {
+        residentBytes -= Footprint(**it);
+        droppableCount--;
+        droppedCount++;
+
+        // The bound on the parent keeps what's needed to cut the space again.
+        const Partition* p = *it;
+        Vector<int> edge(1);
+        edge.PushBack(p->branch->edge);
+        insertBound(p->mstCost, p->parent, p->branch->parent, edge);
+        delete p;
+    }
+
+    // Sorted by cost, the rest is a valid heap as it is.
+    parts.erase(kept, parts.end());
+    std::ranges::sort(parts, PartitionPtrLess());
+    heap = BinaryHeap<Partition*, PartitionPtrLess>(parts);
+}
+
+void PartitionQueue::insertBound(
+    const int cost, const int parent, const std::shared_ptr<const Branch>& branch, const Vector<int>& edges)
+{
+    const auto [it, inserted] = bounds.try_emplace(branch.get(), Bound{ cost, parent, branch, Vector<int>() });
+    Bound& bound = it->second;
+
+    for (const int e : edges)
+        bound.edges.PushBack(e);
+
+    if (inserted || cost < bound.cost) {
+        bound.cost = cost;
+        boundOrder.emplace(cost, branch.get());
+    }
+}
+
+Partition* PartitionQueue::ghostOf(Bound&& bound)
+{
+    Partition* ghost = new Partition(Partition::Choices(0), bound.cost, std::move(bound.edges));
+    ghost->parent = bound.parent;
+    ghost->branch = std::move(bound.branch);
+    ghost->ghost = true;
+    return ghost;
+}
+
+void PartitionQueue::pruneBoundOrder()
+{
+    while (!boundOrder.empty()) {
+        const auto it = bounds.find(boundOrder.top().second);
+        if (it != bounds.end() && it->second.cost == boundOrder.top().first)
+            return;
+        boundOrder.pop();
+    }
+}
+
+void PartitionQueue::Save(std::ostream& os)
+{
+    const uint64_t heapCount = heap.Size();
+    os.write(reinterpret_cast<const char*>(&heapCount), sizeof(heapCount));
+
+    for (const Partition* p : heap.HeapVec())
+        p->Serialize(os);
+
+    for (const auto& [key, bound] : bounds) {
+        const std::unique_ptr<Partition> ghost(ghostOf(Bound(bound)));
+        ghost->Serialize(os);
+    }
+
+    for (const auto& run : runs) {
+        run->head.Serialize(os);
+
+        // The rest of the run is already in the same format, copy it as it is.
+        std::ifstream input(run->path, std::ios::binary);
+        input.seekg(run->input.tellg());
+        if (run->remaining > 0 && !(os << input.rdbuf()))
+            throw std::runtime_error("Can't read spilled run '" + run->path + "'");
+    }
+}
+
+void PartitionQueue::Load(std::istream& is, size_t count)
+{
+    uint64_t heapCount = 0;
+    is.read(reinterpret_cast<char*>(&heapCount), sizeof(heapCount));
+    if (!is || heapCount > count)
+        throw std::runtime_error("Saved partitions are truncated");
+
+    auto read = [&is]() {
+        auto p = std::make_unique<Partition>(0);
+        if (!p->Deserialize(is))
+            throw std::runtime_error("Saved partitions are truncated");
+        return p.release();
+    };
+
+    // Inserting would reorder partitions of equal cost, the saved array is a heap already.
+    std::vector<Partition*> parts;
+    try {
+        for (uint64_t i = 0; i < heapCount; ++i)
+            parts.push_back(read());
+    } catch (...) {
+        for (Partition* p : parts)
+            delete p;
+        throw;
+    }
+
+    heap = BinaryHeap<Partition*, PartitionPtrLess>(parts);
+    for (const Partition* p : parts) {
+        residentBytes += Footprint(*p);
+        if (droppable(*p))
+            droppableCount++;
+    }
+
+    // The ghosts and the spilled ones go wherever the budget lets them.
+    for (size_t i = heapCount; i < count; ++i)
+        Insert(read());
+}
+
+size_t PartitionQueue::cheapestRun() const
+{
+    size_t best = runs.size();
+    for (size_t i = 0; i < runs.size(); ++i)
+        if (best == runs.size() || runs[i]->head.Less(runs[best]->head))
+            best = i;
+    return best;
+}
+
+bool PartitionQueue::advance(size_t runIndex)
+{
+    Run& run = *runs[runIndex];
+
+    if (run.remaining > 0 && run.head.Deserialize(run.input)) {
+        run.remaining--;
+        return true;
+    }
+
+    if (run.remaining > 0)
+        throw std::runtime_error("Spilled run '" + run.path + "' is truncated");
+
+    run.input.close();
+    std::remove(run.path.c_str());
+    runs.erase(runs.begin() + runIndex);
+    return false;
+}
+
+template <typename Writer>
+void PartitionQueue::createRun(Writer write)
+{
+    auto run = std::make_unique<Run>();
+    run->path = spillDirectory + "/kthmst-" + std::to_string(getpid()) +
+                "-" + std::to_string(runCounter++) + ".run";
+
+    std::ofstream output(run->path, std::ios::binary | std::ios::trunc);
+    if (!output)
+        throw std::runtime_error("Can't create spill file '" + run->path + "'");
+
+    const size_t count = write(output);
+    output.close();
+
+    if (!output)
+        throw std::runtime_error("Can't write spill file '" + run->path + "'");
+
+    run->input.open(run->path, std::ios::binary);
+    run->remaining = count;
+    runs.push_back(std::move(run));
+
+    // Load the head, the run always holds at least one partition.
+    advance(runs.size() - 1);
+}
+
+void PartitionQueue::spill()
+{
+    TraceScope span("heap.spill");
+    // Sorted by cost, the cheaper half is a valid heap as it is.
+    std::vector<Partition*> parts = heap.HeapVec();
+    std::ranges::sort(parts, PartitionPtrLess());
+
+    const size_t keep = parts.size() / 2;
+    std::vector<Partition*> cheap(parts.begin(), parts.begin() + keep);
+    heap = BinaryHeap<Partition*, PartitionPtrLess>(cheap);
+
+    createRun([&](std::ofstream& output) {
+        for (size_t i = keep; i < parts.size(); ++i) {
+            residentBytes -= Footprint(*parts[i]);
+            if (droppable(*parts[i]))
+                droppableCount--;
+            parts[i]->Serialize(output);
+            delete parts[i];
+        }
+        return parts.size() - keep;
+    });
+
+    spilledCount += parts.size() - keep;
+
+    if (runs.size() > MAX_RUNS)
+        merge();
+}
+
+void PartitionQueue::merge()
+{
+    TraceScope span("heap.merge");
+
+    // Runs of similar size merge together, the big ones are left alone.
+    std::ranges::sort(runs, {}, [](const std::unique_ptr<Run>& run) { return run->remaining; });
+    const auto merged = runs.begin() + std::min(MERGE_WIDTH, runs.size());
+    std::vector<std::unique_ptr<Run>> sources(
+        std::make_move_iterator(runs.begin()), std::make_move_iterator(merged));
+    runs.erase(runs.begin(), merged);
+
+    createRun([&](std::ofstream& output) {
+        size_t count = 0;
+        std::swap(runs, sources);
+
+        // k-way merge, always writing the cheapest head and advancing its run.
+        while (!runs.empty()) {
+            const size_t r = cheapestRun();
+            runs[r]->head.Serialize(output);
+            count++;
+            advance(r);
+        }
+
+        std::swap(runs, sources);
+        return count;
+    });
+}
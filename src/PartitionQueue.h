@@ -0,0 +1,200 @@
+#ifndef __PARTITION_QUEUE_H
+#define __PARTITION_QUEUE_H
+
+#include "BinaryHeap.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// @brief Orders partition pointers by the cost of their MST.
+struct PartitionPtrLess
+{
+    bool operator()(const Partition* l, const Partition* r) const { return l->Less(*r); }
+};
+
+/// @brief Priority queue of partitions that spills to disk under a memory budget.
+///
+/// Partitions live in an in-memory binary heap as long as their footprint
+/// stays within the budget. Once it's exceeded, the more expensive half of
+/// the heap is sorted and written to a run file on disk. Runs are read back
+/// lazily, one partition at a time: Poll returns whichever is cheaper, the
+/// top of the heap or the smallest head of the runs. When too many runs pile
+/// up the smallest of them are merged into one, so a partition is rewritten
+/// once per tier of run sizes rather than on every merge. Without a budget
+/// it is a plain binary heap.
+///
+/// Alternatively the number of partitions can be bounded. Over the bound
+/// the more expensive half of them is dropped, they leave the heap and
+/// only a bound on their parent is kept: a ghost holding the cheapest cost
+/// of the parent's dropped sub-spaces, the parent's branch chain and the
+/// edges the sub-spaces excluded. A parent has a single ghost however many
+/// of its sub-spaces are dropped. Poll returns the ghost once the output
+/// reaches its cost, the caller cuts the dropped sub-spaces again (see
+/// SpanningTreesFinder::Regenerate). Partitions without a branch chain,
+/// e.g. the ones of an old checkpoint, can't be rebuilt, they are always
+/// kept and don't count.
+class PartitionQueue
+{
+public:
+    /// @brief Constructs an empty queue.
+    /// @param memoryLimit Bytes of partitions kept in memory, 0 means no limit.
+    /// @param spillDirectory Directory of the run files, empty for the system temp directory.
+    /// @param partitionLimit Partitions with a branch kept in the heap, 0 means no limit.
+    explicit PartitionQueue(
+        size_t memoryLimit = 0,
+        const std::string& spillDirectory = "",
+        size_t partitionLimit = 0
+    );
+
+    PartitionQueue(const PartitionQueue&) = delete;
+    PartitionQueue& operator=(const PartitionQueue&) = delete;
+
+    /// @brief Deletes the partitions left in the queue and removes the run files.
+    ~PartitionQueue();
+
+    /// @brief Inserts a partition, the queue takes ownership.
+    void Insert(Partition* p);
+
+    /// @brief Removes the partition with the cheapest MST, the caller takes ownership.
+    /// @return The partition, or the ghost of a parent whose cheapest dropped sub-space is next.
+    /// @throws std::out_of_range If the queue is empty.
+    Partition* Poll();
+
+    /// @brief Writes every partition of the queue, spilled ones included.
+    ///
+    /// The number of partitions in the heap is followed by the heap itself,
+    /// in its own order, by the ghosts and by the runs, all written by
+    /// Partition::Serialize.
+    void Save(std::ostream& os);
+
+    /// @brief Reads partitions written by Save into an empty queue.
+    ///
+    /// The heap is restored exactly as it was, so ties between partitions
+    /// of equal cost are broken the same way as in the saved queue.
+    /// @param is The stream to read from.
+    /// @param count The number of partitions written, Size of the saved queue.
+    /// @throws std::runtime_error if the stream ends early.
+    void Load(std::istream& is, size_t count);
+
+    /// @brief Checks if the queue is empty.
+    [[nodiscard]]
+    bool Empty() const { return Size() == 0; }
+
+    /// @brief Retrieves the number of partitions in the queue, spilled ones and ghosts included.
+    [[nodiscard]]
+    size_t Size() const { return heap.Size() + spilledCount + bounds.size(); }
+
+    /// @brief Retrieves the number of partitions currently on disk.
+    [[nodiscard]]
+    size_t SpilledCount() const { return spilledCount; }
+
+    /// @brief Retrieves the number of partitions dropped so far.
+    [[nodiscard]]
+    size_t DroppedCount() const { return droppedCount; }
+
+    /// @brief Retrieves the bytes taken by the partitions held in memory.
+    [[nodiscard]]
+    size_t ResidentBytes() const { return residentBytes; }
+
+    /// @brief Estimates the memory taken by a partition.
+    [[nodiscard]]
+    static size_t Footprint(const Partition& p);
+
+private:
+    /// A sorted run of partitions on disk, its smallest partition is held in memory.
+    struct Run
+    {
+        std::string path;
+        std::ifstream input;
+        size_t remaining = 0; ///< Partitions still in the file, the head excluded.
+        Partition head{0};    ///< The cheapest partition not yet polled.
+    };
+
+    static constexpr size_t MAX_RUNS = 16;   ///< More runs than this get merged.
+    static constexpr size_t MERGE_WIDTH = 8; ///< Runs merged at once, the smallest ones.
+
+    /// Names the run files, shared so that queues of one process never clash.
+    static std::atomic<size_t> runCounter;
+
+    /// The dropped sub-spaces of a parent, what Poll turns into a ghost.
+    struct Bound
+    {
+        int cost;                             ///< Cheapest MST of the sub-spaces.
+        int parent;                           ///< Output index of the parent.
+        std::shared_ptr<const Branch> branch; ///< Chain of the parent.
+        Vector<int> edges;                    ///< Edges the sub-spaces excluded.
+    };
+
+    /// Cost of a bound and its key, the cheapest on top.
+    using BoundEntry = std::pair<int, const Branch*>;
+
+    BinaryHeap<Partition*, PartitionPtrLess> heap;
+    std::vector<std::unique_ptr<Run>> runs;
+
+    /// Bounds by the branch chain of their parent, null for the MST.
+    std::unordered_map<const Branch*, Bound> bounds;
+
+    /// Orders the bounds. A lowered one is pushed again, the entries
+    /// whose cost no longer matches their bound are skipped.
+    std::priority_queue<BoundEntry, std::vector<BoundEntry>, std::greater<BoundEntry>> boundOrder;
+
+    size_t memoryLimit;
+    std::string spillDirectory;
+    size_t partitionLimit;
+    size_t droppableCount = 0; ///< Partitions in the heap that could be dropped.
+    size_t droppedCount = 0;   ///< Partitions dropped so far.
+    size_t residentBytes = 0;  ///< Footprint of the heap.
+    size_t spilledCount = 0;   ///< Partitions in the runs, heads included.
+
+    /// @brief Checks if a partition can be cut again from its parent's branch chain.
+    static bool droppable(const Partition& p) { return !p.ghost && p.branch; }
+
+    /// @brief Moves the more expensive half of the heap into a new run.
+    void spill();
+
+    /// @brief Drops the more expensive half of the droppable partitions in the heap.
+    void drop();
+
+    /// @brief Records a dropped sub-space, merging it into the bound of its parent.
+    /// @param cost The MST cost of the sub-space.
+    /// @param parent Output index of the parent.
+    /// @param branch Chain of the parent.
+    /// @param edges Edges excluded by the sub-space, more of them for a loaded ghost.
+    void insertBound(int cost, int parent, const std::shared_ptr<const Branch>& branch, const Vector<int>& edges);
+
+    /// @brief Turns a bound into a ghost partition.
+    [[nodiscard]]
+    static Partition* ghostOf(Bound&& bound);
+
+    /// @brief Removes the stale entries from the top of boundOrder.
+    void pruneBoundOrder();
+
+    /// @brief Merges the MERGE_WIDTH smallest runs into a single one.
+    void merge();
+
+    /// @brief Creates a run file from partitions sorted by cost and opens it for reading.
+    /// @param write Callback writing the partitions, returns how many it wrote.
+    template <typename Writer>
+    void createRun(Writer write);
+
+    /// @brief Loads the next partition of a run into its head, removes the run when it's empty.
+    /// @return `false` if the run was removed.
+    bool advance(size_t runIndex);
+
+    /// @brief Finds the run with the cheapest head.
+    /// @return Its index, or runs.size() if there are no runs.
+    [[nodiscard]]
+    size_t cheapestRun() const;
+};
+
+#endif // __PARTITION_QUEUE_H
@@ -0,0 +1,170 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* PHASE_NAMES[PerfReport::PHASE_COUNT] = {
+    "parse", "graph_build", "initial_mst", "expansion", "heap", "validation", "output",
+};
+
+static const char* EVENT_NAMES[PerfReport::EVENT_COUNT] = {
+    "cycles", "instructions", "cache_misses", "branch_misses", "dtlb_misses",
+};
+
+const char* PerfReport::PhaseName(Phase phase)
+{
+    return PHASE_NAMES[phase];
+}
+
+void PerfReport::WriteJson(std::ostream& os, size_t indent) const
+{
+    const std::string pad(indent, ' ');
+
+    os << "{\n" << pad << "  \"available\": " << (available ? "true" : "false");
+
+    if (!available) {
+        os << ",\n" << pad << "  \"reason\": \"" << reason << "\"\n" << pad << "}";
+        return;
+    }
+
+    os << ",\n" << pad << "  \"phases\": {";
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        const auto& v = values[p];
+        os << (p ? ",\n" : "\n") << pad << "    \"" << PHASE_NAMES[p] << "\": { ";
+
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            os << (e ? ", " : "") << "\"" << EVENT_NAMES[e] << "\": ";
+            if (counted[e])
+                os << v[e];
+            else
+                os << "null";
+        }
+
+        os << ", \"ipc\": ";
+        if (counted[CYCLES] && counted[INSTRUCTIONS] && v[CYCLES] > 0)
+            os << (double)v[INSTRUCTIONS] / v[CYCLES];
+        else
+            os << "null";
+        os << " }";
+    }
+    os << "\n" << pad << "  }\n" << pad << "}";
+}
+
+#ifdef __linux__
+
+/// The group is read with its ids, members that failed to open are simply missing.
+struct GroupRead
+{
+    uint64_t count;
+    struct { uint64_t value; uint64_t id; } events[PerfReport::EVENT_COUNT];
+};
+
+PerfCounters::PerfCounters()
+{
+    for (int& fd : fds)
+        fd = -1;
+
+    const uint64_t dtlbReadMiss = PERF_COUNT_HW_CACHE_DTLB |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    const std::pair<uint32_t, uint64_t> events[PerfReport::EVENT_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, dtlbReadMiss },
+    };
+
+    for (int e = 0; e < PerfReport::EVENT_COUNT; ++e) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[e].first;
+        attr.config = events[e].second;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.disabled = e == 0; // The leader starts the whole group.
+
+        const int fd = syscall(SYS_perf_event_open, &attr, 0, -1, e == 0 ? -1 : fds[0], 0);
+
+        if (fd < 0) {
+            // Without cycles there's no group to join.
+            if (e == 0) {
+                report.reason = std::string("perf_event_open failed: ") + strerror(errno);
+                return;
+            }
+            continue;
+        }
+
+        fds[e] = fd;
+        ioctl(fd, PERF_EVENT_IOC_ID, &ids[e]);
+        report.counted[e] = true;
+    }
+
+    report.available = true;
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (const int fd : fds)
+        if (fd >= 0)
+            close(fd);
+}
+
+void PerfCounters::charge()
+{
+    GroupRead group;
+    if (read(fds[0], &group, sizeof(group)) <= 0)
+        return;
+
+    for (uint64_t i = 0; i < group.count && i < PerfReport::EVENT_COUNT; ++i) {
+        for (int e = 0; e < PerfReport::EVENT_COUNT; ++e) {
+            if (fds[e] < 0 || ids[e] != group.events[i].id)
+                continue;
+            report.values[current][e] += group.events[i].value - last[e];
+            last[e] = group.events[i].value;
+        }
+    }
+}
+
+#else
+
+PerfCounters::PerfCounters()
+{
+    for (int& fd : fds)
+        fd = -1;
+    report.reason = "perf events are only supported on Linux";
+}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::charge() {}
+
+#endif
+
+PerfCounters::Phase PerfCounters::Switch(Phase phase)
+{
+    const Phase previous = current;
+    if (report.available && phase != current) {
+        charge();
+        current = phase;
+    }
+    return previous;
+}
+
+PerfReport PerfCounters::Report()
+{
+    if (report.available)
+        charge();
+    return report;
+}
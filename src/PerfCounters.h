@@ -0,0 +1,125 @@
+#ifndef __PERF_COUNTERS_H
+#define __PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/// @brief Hardware counters of every phase of a run, see PerfCounters.
+struct PerfReport
+{
+    enum Phase {
+        PARSE,       ///< Reading the input file into edges, or generating it.
+        GRAPH_BUILD, ///< Sorting the edges into the graph.
+        INITIAL_MST, ///< The first Kruskal's run, or loading a checkpoint.
+        EXPANSION,   ///< Cutting search spaces and their Kruskal's runs.
+        HEAP,        ///< Frontier inserts and polls.
+        VALIDATION,  ///< Checking the trees for cycles and duplicates.
+        OUTPUT,      ///< Storing and printing the trees.
+        PHASE_COUNT,
+    };
+
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        DTLB_MISSES,
+        EVENT_COUNT,
+    };
+
+    bool available = false;
+    std::string reason;                ///< Why the counters are unavailable.
+    std::array<bool, EVENT_COUNT> counted{}; ///< Events the hardware could count.
+
+    /// Counts per phase and event.
+    std::array<std::array<uint64_t, EVENT_COUNT>, PHASE_COUNT> values{};
+
+    /// @brief Retrieves the name of a phase, as used in the JSON.
+    [[nodiscard]]
+    static const char* PhaseName(Phase phase);
+
+    /// @brief Writes the report as a JSON object.
+    /// @param os The output stream.
+    /// @param indent Spaces in front of the nested lines.
+    void WriteJson(std::ostream& os, size_t indent) const;
+};
+
+/// @brief Counts cycles, instructions, cache, branch and TLB misses per phase.
+///
+/// The counters are a single perf_event_open group on the calling thread,
+/// user space only, so the verifier's workers are not counted. Exactly one
+/// phase is current at any time; switching phases reads the group and
+/// charges the difference to the phase that was current. Every switch is a
+/// read(2), the counters are meant for profiling runs only.
+///
+/// When the kernel refuses perf events (e.g. perf_event_paranoid, seccomp
+/// or a virtual machine without a PMU), the counters stay unavailable, every
+/// switch does nothing and the report says why.
+class PerfCounters
+{
+public:
+    using Phase = PerfReport::Phase;
+
+    /// @brief Opens and starts the counters, charging everything to PARSE.
+    PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters();
+
+    /// @brief Checks if the kernel allowed the counters.
+    [[nodiscard]]
+    bool Available() const { return report.available; }
+
+    /// @brief Makes a phase current.
+    /// @return The phase that was current before.
+    Phase Switch(Phase phase);
+
+    /// @brief Retrieves the counts so far, the current phase included.
+    [[nodiscard]]
+    PerfReport Report();
+
+private:
+    int fds[PerfReport::EVENT_COUNT];
+    uint64_t ids[PerfReport::EVENT_COUNT] = {};
+    uint64_t last[PerfReport::EVENT_COUNT] = {}; ///< Counts at the last switch.
+    Phase current = PerfReport::PARSE;
+    PerfReport report;
+
+    /// @brief Charges the counts since the last switch to the current phase.
+    void charge();
+};
+
+/// @brief Makes a phase current for the lifetime of the scope.
+///
+/// Does nothing when the counters are null, so the scopes can stay in the
+/// code whether counting was requested or not.
+class PerfScope
+{
+public:
+    PerfScope(PerfCounters* counters, PerfReport::Phase phase)
+    : counters(counters)
+    {
+        if (counters)
+            previous = counters->Switch(phase);
+    }
+
+    ~PerfScope()
+    {
+        if (counters)
+            counters->Switch(previous);
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfCounters* counters;
+    PerfReport::Phase previous = PerfReport::PARSE;
+};
+
+#endif // __PERF_COUNTERS_H
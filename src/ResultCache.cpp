@@ -0,0 +1,151 @@
+#include "ResultCache.h"
+#include "Checkpoint.h"
+#include "ResultFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+ResultCache::ResultCache(const std::string& directory, size_t maxBytes)
+: directory(directory), maxBytes(maxBytes)
+{
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (!fs::is_directory(directory))
+        throw std::runtime_error("Can't create cache directory '" + directory + "'");
+}
+
+size_t ResultCache::Solve(
+    const Graph& g, const SpanningTreesFinder::TreeCallback& onTree, SolveOptions options)
+{
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)g.Hash());
+    const std::string entry = (fs::path(directory) / key).string();
+    const std::string treesPath = entry + ".kres";
+    const std::string frontierPath = entry + ".ckpt";
+
+    // The two files of an entry are replaced one after the other,
+    // an entry whose files don't match is as good as missing.
+    std::unique_ptr<ResultFileReader> cached;
+    bool complete = false;
+    CheckpointHeader header;
+
+    if (fs::exists(treesPath) && Checkpoint::ReadHeader(frontierPath, header)) {
+        try {
+            cached = std::make_unique<ResultFileReader>(treesPath.c_str());
+        } catch (const std::runtime_error&) {}
+
+        if (cached && (cached->GraphHash() != g.Hash() ||
+                       cached->VertexCount() != g.VertexCount() ||
+                       cached->EdgeCount() != g.EdgeCount() ||
+                       header.graphHash != g.Hash() ||
+                       header.emitted != cached->TreeCount()))
+            cached.reset();
+
+        complete = cached && header.partitionCount == 0;
+    }
+
+    const size_t available = cached ? cached->TreeCount() : 0;
+    const size_t wanted = options.treeLimit;
+
+    if (cached) {
+        // The modification time orders the entries for the eviction.
+        std::error_code error;
+        const auto now = fs::file_time_type::clock::now();
+        fs::last_write_time(treesPath, now, error);
+        fs::last_write_time(frontierPath, now, error);
+    }
+
+    const size_t served = wanted ? std::min(wanted, available) : available;
+    for (size_t i = 0; i < served; ++i)
+        if (!onTree(cached->Tree(i)))
+            return i;
+
+    if (complete || (wanted && available >= wanted))
+        return served;
+
+    // Extend the prefix, writing a new entry next to the old one.
+    const std::string suffix = "." + std::to_string(getpid()) + ".tmp";
+    const std::string tmpTreesPath = treesPath + suffix;
+    const std::string tmpFrontierPath = frontierPath + suffix;
+
+    try {
+        ResultFileWriter trees(tmpTreesPath.c_str(), g);
+        for (size_t i = 0; i < available; ++i)
+            trees.Append(cached->Tree(i));
+
+        options.resumePath = cached ? frontierPath : "";
+        options.checkpointPath = tmpFrontierPath;
+
+        SpanningTreesFinder::Solve(g, [&](const Partition& p) {
+            if (!onTree(p))
+                return false;
+            trees.Append(p);
+            return true;
+        }, options);
+
+        trees.Close();
+    } catch (...) {
+        std::remove(tmpTreesPath.c_str());
+        std::remove(tmpFrontierPath.c_str());
+        throw;
+    }
+
+    cached.reset();
+    if (std::rename(tmpTreesPath.c_str(), treesPath.c_str()) != 0 ||
+        std::rename(tmpFrontierPath.c_str(), frontierPath.c_str()) != 0)
+        throw std::runtime_error("Can't store the trees in the cache '" + directory + "'");
+
+    evict(entry);
+    return served;
+}
+
+void ResultCache::evict(const std::string& keep)
+{
+    if (maxBytes == 0)
+        return;
+
+    struct Entry
+    {
+        size_t bytes = 0;
+        fs::file_time_type used;
+    };
+
+    std::map<std::string, Entry> entries;
+    size_t total = 0;
+    std::error_code error;
+
+    for (const fs::directory_entry& file : fs::directory_iterator(directory, error)) {
+        const fs::path& path = file.path();
+        if (!file.is_regular_file(error) || (path.extension() != ".kres" && path.extension() != ".ckpt"))
+            continue;
+
+        Entry& e = entries[(path.parent_path() / path.stem()).string()];
+        const size_t bytes = file.file_size(error);
+        e.bytes += bytes;
+        e.used = std::max(e.used, file.last_write_time(error));
+        total += bytes;
+    }
+
+    std::vector<std::pair<fs::file_time_type, std::string>> byAge;
+    for (const auto& [stem, e] : entries)
+        if (stem != keep)
+            byAge.emplace_back(e.used, stem);
+    std::ranges::sort(byAge);
+
+    for (const auto& [used, stem] : byAge) {
+        if (total <= maxBytes)
+            break;
+        fs::remove(stem + ".kres", error);
+        fs::remove(stem + ".ckpt", error);
+        total -= entries[stem].bytes;
+    }
+}
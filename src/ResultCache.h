@@ -0,0 +1,54 @@
+#ifndef __RESULT_CACHE_H
+#define __RESULT_CACHE_H
+
+#include "Graph.h"
+#include "SpanningTreesFinder.h"
+
+#include <cstddef>
+#include <string>
+
+/// @brief Keeps enumerated trees of graphs on disk across runs.
+///
+/// An entry is named by Graph::Hash, which covers the sorted edges with
+/// their weights, and holds the trees enumerated so far as a binary result
+/// file (`<hash>.kres`) together with a checkpoint of the frontier right
+/// after them (`<hash>.ckpt`). A run asking for no more trees than the
+/// entry holds is answered from the result file alone, a run asking for
+/// more resumes the search from the checkpoint and stores the longer
+/// prefix back. Entries used least recently are evicted once the
+/// directory grows over its size bound.
+class ResultCache
+{
+public:
+    /// @brief Opens a cache directory, creating it if needed.
+    /// @param directory The directory of the entries.
+    /// @param maxBytes Size the entries may take together, 0 for no bound.
+    /// @throws std::runtime_error if the directory can't be created.
+    ResultCache(const std::string& directory, size_t maxBytes);
+
+    /// @brief Streams the trees of the graph, taking as many as possible from the cache.
+    ///
+    /// Trees are handed to the callback in the order SpanningTreesFinder::Solve
+    /// would hand them over. Trees read from the cache have no choices and
+    /// no parent. Whatever the search adds is stored back in the cache.
+    /// @param g The graph for which to find spanning trees.
+    /// @param onTree Callback receiving every tree, returns `false` to stop.
+    /// @param options Options of the search, SolveOptions::treeLimit is the number of trees wanted.
+    ///                Checkpoints are used by the cache, they can't be set.
+    /// @return The number of trees taken from the cache.
+    size_t Solve(
+        const Graph& g,
+        const SpanningTreesFinder::TreeCallback& onTree,
+        SolveOptions options
+    );
+
+private:
+    std::string directory;
+    size_t maxBytes;
+
+    /// @brief Removes the least recently used entries until the cache fits its bound.
+    /// @param keep Path of the entry (without the extension) never to remove.
+    void evict(const std::string& keep);
+};
+
+#endif // __RESULT_CACHE_H
@@ -0,0 +1,200 @@
+#include "ResultFile.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(ResultFileHeader) == 64, "The header is written as is");
+static_assert(sizeof(ResultFileCostLevel) == 16, "The index is written as is");
+
+static constexpr char RESULT_MAGIC[8] = { 'K', 'M', 'S', 'T', 'R', 'S', 'L', 'T' };
+static constexpr uint32_t RESULT_VERSION = 1;
+
+ResultFileWriter::ResultFileWriter(const char* path, const Graph& g)
+: path(path), output(path, std::ios::binary | std::ios::trunc), header{}
+{
+    if (!output)
+        throw std::runtime_error(std::string("Can't create result file ") + path);
+
+    memcpy(header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+    header.version = RESULT_VERSION;
+    header.vertexCount = g.VertexCount();
+    header.edgeCount = g.EdgeCount();
+    header.recordStride = sizeof(int32_t) + sizeof(uint32_t) * (g.VertexCount() - 1);
+    header.graphHash = g.Hash();
+    header.recordsOffset = sizeof(ResultFileHeader);
+
+    // Rewritten by Close, a file that wasn't closed reads as empty.
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+ResultFileWriter::~ResultFileWriter()
+{
+    if (closed)
+        return;
+
+    try {
+        Close();
+    } catch (const std::runtime_error&) {
+        // The file stays unfinished, it reads as empty.
+    }
+}
+
+void ResultFileWriter::Append(const Partition& p)
+{
+    if (p.mstEdges.Size() != header.vertexCount - 1)
+        throw std::runtime_error("Tree has a wrong number of edges");
+
+    if (levels.Empty() || levels.Back().cost < p.mstCost) {
+        levels.PushBack(ResultFileCostLevel{ p.mstCost, header.treeCount });
+    } else if (p.mstCost < levels.Back().cost) {
+        throw std::runtime_error("Trees must be appended in non-decreasing order of cost");
+    }
+
+    const int32_t cost = p.mstCost;
+    output.write(reinterpret_cast<const char*>(&cost), sizeof(cost));
+    for (const int e : p.mstEdges) {
+        const uint32_t index = e;
+        output.write(reinterpret_cast<const char*>(&index), sizeof(index));
+    }
+
+    header.treeCount++;
+}
+
+void ResultFileWriter::Close()
+{
+    if (closed)
+        return;
+    closed = true;
+
+    // Keep the index 8-byte aligned for the readers.
+    uint64_t offset = header.recordsOffset + header.treeCount * header.recordStride;
+    while (offset % 8) {
+        output.put(0);
+        offset++;
+    }
+
+    header.indexOffset = offset;
+    header.indexCount = levels.Size();
+    for (const ResultFileCostLevel& level : levels)
+        output.write(reinterpret_cast<const char*>(&level), sizeof(level));
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.close();
+
+    if (!output)
+        throw std::runtime_error("Can't write result file " + path);
+}
+
+ResultFileReader::ResultFileReader(const char* path)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Can't open result file ") + path);
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ResultFileHeader)) {
+        close(fd);
+        throw std::runtime_error(std::string("Not a result file ") + path);
+    }
+
+    size = st.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error(std::string("Can't map result file ") + path);
+
+    data = static_cast<const unsigned char*>(mapping);
+    memcpy(&header, data, sizeof(header));
+
+    const bool valid =
+        memcmp(header.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC)) == 0 &&
+        header.version == RESULT_VERSION &&
+        header.vertexCount > 0 &&
+        header.recordStride == sizeof(int32_t) + sizeof(uint32_t) * (header.vertexCount - 1) &&
+        header.recordsOffset + header.treeCount * header.recordStride <= size &&
+        header.indexOffset + header.indexCount * sizeof(ResultFileCostLevel) <= size;
+
+    if (!valid) {
+        munmap(const_cast<unsigned char*>(data), size);
+        throw std::runtime_error(std::string("Malformed result file ") + path);
+    }
+}
+
+ResultFileReader::~ResultFileReader()
+{
+    munmap(const_cast<unsigned char*>(data), size);
+}
+
+bool ResultFileReader::IsResultFile(const char* path)
+{
+    char magic[sizeof(RESULT_MAGIC)] = {};
+    std::ifstream input(path, std::ios::binary);
+    input.read(magic, sizeof(magic));
+    return input && memcmp(magic, RESULT_MAGIC, sizeof(magic)) == 0;
+}
+
+void ResultFileReader::checkTree(const size_t i) const
+{
+    if (i >= header.treeCount)
+        throw std::out_of_range("Tree index out of bounds. INDEX: " + std::to_string(i) +
+                                ", COUNT: " + std::to_string(header.treeCount));
+}
+
+int ResultFileReader::Cost(const size_t i) const
+{
+    checkTree(i);
+    int32_t cost;
+    memcpy(&cost, data + header.recordsOffset + i * header.recordStride, sizeof(cost));
+    return cost;
+}
+
+const uint32_t* ResultFileReader::Edges(const size_t i) const
+{
+    checkTree(i);
+    return reinterpret_cast<const uint32_t*>(
+        data + header.recordsOffset + i * header.recordStride + sizeof(int32_t));
+}
+
+Partition ResultFileReader::Tree(const size_t i) const
+{
+    const uint32_t* edges = Edges(i);
+    Vector<int> mstEdges(header.vertexCount - 1, 0);
+    for (size_t e = 0; e < header.vertexCount - 1; ++e)
+        mstEdges[e] = edges[e];
+
+    return Partition(Partition::Choices(), Cost(i), mstEdges);
+}
+
+ResultFileCostLevel ResultFileReader::level(const size_t j) const
+{
+    ResultFileCostLevel entry;
+    memcpy(&entry, data + header.indexOffset + j * sizeof(entry), sizeof(entry));
+    return entry;
+}
+
+std::pair<size_t, size_t> ResultFileReader::TreesAtCost(const int cost) const
+{
+    // Binary search for the first level with a cost that's not lower.
+    size_t lo = 0, hi = header.indexCount;
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (level(mid).cost < cost)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == header.indexCount || level(lo).cost != cost)
+        return { 0, 0 };
+
+    const size_t last = lo + 1 < header.indexCount ? level(lo + 1).first : header.treeCount;
+    return { level(lo).first, last };
+}
@@ -0,0 +1,142 @@
+#ifndef __RESULT_FILE_H
+#define __RESULT_FILE_H
+
+#include "Graph.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+
+/// @brief Header of a binary result file, all fields are little-endian.
+///
+/// The header is followed by `treeCount` fixed-stride records, each holding
+/// an i32 cost and the u32 indices of the tree's |V|-1 edges, and by the
+/// cost-level index: `indexCount` entries of (i64 cost, u64 first tree),
+/// one per distinct cost, in increasing order.
+struct ResultFileHeader
+{
+    char magic[8];          ///< "KMSTRSLT"
+    uint32_t version;       ///< Format version.
+    uint32_t vertexCount;   ///< |V| of the graph.
+    uint32_t edgeCount;     ///< |E| of the graph.
+    uint32_t recordStride;  ///< Size of a record in bytes.
+    uint64_t graphHash;     ///< Graph::Hash of the graph.
+    uint64_t treeCount;     ///< Number of records.
+    uint64_t recordsOffset; ///< File offset of the first record.
+    uint64_t indexOffset;   ///< File offset of the cost-level index.
+    uint64_t indexCount;    ///< Number of cost levels.
+};
+
+/// @brief One entry of the cost-level index.
+struct ResultFileCostLevel
+{
+    int64_t cost;   ///< Cost of the level.
+    uint64_t first; ///< Index of the first tree with this cost.
+};
+
+/// @brief Writes trees into a binary result file as they are found.
+///
+/// Trees have to be appended in non-decreasing order of cost (the order
+/// they come out of SpanningTreesFinder::Solve), the cost-level index is
+/// collected on the way and written by Close.
+class ResultFileWriter
+{
+public:
+    /// @brief Creates the file and writes a provisional header.
+    /// @param path The path of the file.
+    /// @param g The graph the trees belong to.
+    /// @throws std::runtime_error if the file can't be created.
+    ResultFileWriter(const char* path, const Graph& g);
+
+    ResultFileWriter(const ResultFileWriter&) = delete;
+    ResultFileWriter& operator=(const ResultFileWriter&) = delete;
+
+    /// @brief Closes the file if Close wasn't called, errors are ignored there.
+    ~ResultFileWriter();
+
+    /// @brief Appends a tree to the file.
+    /// @param p The partition holding the tree.
+    /// @throws std::runtime_error if the tree is cheaper than the previous one.
+    void Append(const Partition& p);
+
+    /// @brief Writes the cost-level index and the final header.
+    /// @throws std::runtime_error if the file couldn't be written completely.
+    void Close();
+
+    /// @brief Retrieves the number of trees appended so far.
+    [[nodiscard]]
+    size_t TreeCount() const { return header.treeCount; }
+
+private:
+    std::string path;
+    std::ofstream output;
+    ResultFileHeader header;
+    Vector<ResultFileCostLevel> levels; ///< Cost-level index collected so far.
+    bool closed = false;
+};
+
+/// @brief Random access to the trees of a binary result file.
+///
+/// The file is memory-mapped, so opening it is O(1) regardless of its
+/// size, the i-th tree is found at a fixed offset and the trees of a given
+/// cost are found by a binary search over the cost-level index.
+class ResultFileReader
+{
+public:
+    /// @brief Maps the file into memory and validates its header.
+    /// @param path The path of the file.
+    /// @throws std::runtime_error if the file can't be mapped or is malformed.
+    explicit ResultFileReader(const char* path);
+
+    ResultFileReader(const ResultFileReader&) = delete;
+    ResultFileReader& operator=(const ResultFileReader&) = delete;
+
+    /// @brief Unmaps the file.
+    ~ResultFileReader();
+
+    /// @brief Checks if the file starts with the result file magic.
+    /// @param path The path of the file.
+    [[nodiscard]]
+    static bool IsResultFile(const char* path);
+
+    [[nodiscard]] size_t VertexCount() const { return header.vertexCount; } ///< |V| of the graph.
+    [[nodiscard]] size_t EdgeCount() const { return header.edgeCount; }     ///< |E| of the graph.
+    [[nodiscard]] size_t TreeCount() const { return header.treeCount; }     ///< Number of trees.
+    [[nodiscard]] uint64_t GraphHash() const { return header.graphHash; }   ///< Graph::Hash of the graph.
+
+    /// @brief Retrieves the cost of the i-th tree.
+    [[nodiscard]]
+    int Cost(size_t i) const;
+
+    /// @brief Retrieves the |V|-1 edge indices of the i-th tree.
+    [[nodiscard]]
+    const uint32_t* Edges(size_t i) const;
+
+    /// @brief Copies the i-th tree into a partition (without choices).
+    [[nodiscard]]
+    Partition Tree(size_t i) const;
+
+    /// @brief Finds the trees of the given cost.
+    /// @return The half-open range [first, last) of tree indices, empty if there's none.
+    [[nodiscard]]
+    std::pair<size_t, size_t> TreesAtCost(int cost) const;
+
+private:
+    ResultFileHeader header;
+    const unsigned char* data = nullptr; ///< The mapped file.
+    size_t size = 0;                     ///< Size of the mapping.
+
+    /// @brief Retrieves the j-th entry of the cost-level index.
+    [[nodiscard]]
+    ResultFileCostLevel level(size_t j) const;
+
+    /// @brief Checks the index bounds of a tree.
+    /// @throws std::out_of_range if there's no such tree.
+    void checkTree(size_t i) const;
+};
+
+#endif // __RESULT_FILE_H
@@ -0,0 +1,191 @@
+#include "Reweighting.h"
+#include "DisjointSet.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+Graph Reweighting::Apply(
+    const Graph& g,
+    const Vector<WeightUpdate>& updates,
+    SolveState& state,
+    const Vector<Partition>& emitted,
+    Report* report)
+{
+    const Vector<Edge>& edges = g.Edges();
+    const size_t edgeCount = g.EdgeCount();
+
+    // Resolve all the updates first, a wrong one leaves the search as it was.
+    Vector<int> changed;
+    for (const WeightUpdate& u : updates) {
+        if (u.weight == 0)
+            throw std::runtime_error("An edge can't be reweighted to 0");
+
+        size_t i = 0;
+        while (i < edgeCount &&
+               !((edges[i].nodeX == u.nodeX && edges[i].nodeY == u.nodeY) ||
+                 (edges[i].nodeX == u.nodeY && edges[i].nodeY == u.nodeX)))
+            i++;
+
+        if (i == edgeCount)
+            throw std::runtime_error("No edge (" + std::to_string(u.nodeX) + ", " +
+                                     std::to_string(u.nodeY) + ") in the graph");
+        changed.PushBack(i);
+    }
+
+    if ((size_t)state.emitted != emitted.Size())
+        throw std::runtime_error("Every emitted tree is needed to re-rank the search");
+
+    std::vector<Partition*> parts;
+    while (!state.partitions.Empty())
+        parts.push_back(state.partitions.Poll());
+
+    // Dropped spaces are rebuilt by replaying their branch chain, the new weights would break it.
+    if (std::ranges::any_of(parts, [](const Partition* p) { return p->ghost || p->branch; })) {
+        for (Partition* p : parts)
+            state.partitions.Insert(p);
+        throw std::runtime_error("A bounded search can't be re-ranked");
+    }
+
+    // An emitted tree comes back as a space of its own, every other edge excluded.
+    for (const Partition& tree : emitted) {
+        auto* p = new Partition(Partition::Choices(edgeCount, Partition::EXCLUDED), 0, tree.mstEdges);
+        for (const int e : p->mstEdges)
+            p->choices[e] = Partition::INCLUDED;
+        parts.push_back(p);
+    }
+
+    Vector<int> weights(edgeCount, 0);
+    for (size_t i = 0; i < edgeCount; ++i)
+        weights[i] = edges[i].weight;
+
+    // One change at a time, each keeps every tree minimal with at most one swap.
+    Report r;
+    Vector<char> touched(parts.size(), 0);
+    for (size_t j = 0; j < changed.Size(); ++j) {
+        for (size_t k = 0; k < parts.size(); ++k) {
+            if (repair(*parts[k], changed[j], updates[j].weight, g, weights)) {
+                r.swaps++;
+                touched[k] = 1;
+            }
+        }
+        weights[changed[j]] = updates[j].weight;
+    }
+
+    // The edges get sorted by their new weights, the indices of every space follow them.
+    Vector<int> order(edgeCount, 0);
+    for (size_t i = 0; i < edgeCount; ++i)
+        order[i] = i;
+    std::ranges::stable_sort(order, [&weights](const int l, const int r) { return weights[l] < weights[r]; });
+
+    Vector<int> newIndex(edgeCount, 0);
+    Vector<Edge> newEdges;
+    for (size_t i = 0; i < edgeCount; ++i) {
+        newIndex[order[i]] = i;
+        newEdges.EmplaceBack(edges[order[i]].nodeX, edges[order[i]].nodeY, weights[order[i]]);
+    }
+
+    for (Partition* p : parts) {
+        Partition::Choices choices(edgeCount, Partition::NOT_ASSESSED);
+        for (size_t i = 0; i < edgeCount; ++i)
+            choices[newIndex[i]] = p->choices[i];
+        p->choices = std::move(choices);
+
+        p->mstCost = 0;
+        for (int& e : p->mstEdges) {
+            p->mstCost += weights[e];
+            e = newIndex[e];
+        }
+        std::ranges::sort(p->mstEdges);
+
+        // The output starts over, the parents would point at the old order.
+        p->parent = -1;
+        state.partitions.Insert(p);
+    }
+
+    state.emitted = 0;
+
+    r.partitions = parts.size();
+    for (const char t : touched)
+        r.repaired += t;
+    if (report)
+        *report = r;
+
+    // The kernels of the search hold the old order of the edges.
+    Graph reweighted(g.VertexCount(), newEdges);
+    state.RebuildKernels(reweighted);
+    return reweighted;
+}
+
+bool Reweighting::repair(
+    Partition& p, const int edge, const int weight, const Graph& g, const Vector<int>& weights)
+{
+    // Fixed edges stay as they are whatever they weigh.
+    if (p.choices[edge] != Partition::NOT_ASSESSED)
+        return false;
+
+    const Vector<Edge>& edges = g.Edges();
+    int* slot = std::ranges::find(p.mstEdges, edge);
+    const bool inTree = slot != p.mstEdges.end();
+
+    if (inTree && weight > weights[edge]) {
+        // Cut the tree at the edge, the lightest free edge across the cut may take its place.
+        DisjointSet<int> ds(g.VertexCount());
+        for (const int e : p.mstEdges)
+            if (e != edge)
+                ds.Unify(edges[e].nodeX, edges[e].nodeY);
+
+        int best = -1;
+        for (size_t i = 0; i < edges.Size(); ++i) {
+            if (p.choices[i] != Partition::NOT_ASSESSED || (int)i == edge || weights[i] >= weight ||
+                (best >= 0 && weights[i] >= weights[best]))
+                continue;
+            if (!ds.NodesConnected(edges[i].nodeX, edges[i].nodeY))
+                best = i;
+        }
+
+        if (best < 0)
+            return false;
+        *slot = best;
+    } else if (!inTree && weight < weights[edge]) {
+        // The heaviest free edge on the tree path between the ends may make way for it.
+        std::vector<std::vector<std::pair<int, int>>> adjacent(g.VertexCount());
+        for (const int e : p.mstEdges) {
+            adjacent[edges[e].nodeX].emplace_back(edges[e].nodeY, e);
+            adjacent[edges[e].nodeY].emplace_back(edges[e].nodeX, e);
+        }
+
+        std::vector<int> via(g.VertexCount(), -1);
+        std::vector<int> stack{ edges[edge].nodeX };
+        via[edges[edge].nodeX] = edge;
+        while (!stack.empty() && via[edges[edge].nodeY] < 0) {
+            const int v = stack.back();
+            stack.pop_back();
+            for (const auto& [u, e] : adjacent[v]) {
+                if (via[u] < 0) {
+                    via[u] = e;
+                    stack.push_back(u);
+                }
+            }
+        }
+
+        int worst = -1;
+        for (int v = edges[edge].nodeY; v != edges[edge].nodeX; ) {
+            const int e = via[v];
+            if (p.choices[e] == Partition::NOT_ASSESSED && (worst < 0 || weights[e] > weights[worst]))
+                worst = e;
+            v = edges[e].nodeX == v ? edges[e].nodeY : edges[e].nodeX;
+        }
+
+        if (worst < 0 || weights[worst] <= weight)
+            return false;
+        *std::ranges::find(p.mstEdges, worst) = edge;
+    } else {
+        return false;
+    }
+
+    std::ranges::sort(p.mstEdges);
+    return true;
+}
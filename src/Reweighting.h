@@ -0,0 +1,76 @@
+#ifndef __REWEIGHTING_H
+#define __REWEIGHTING_H
+
+#include "Graph.h"
+#include "Partition.h"
+#include "SpanningTreesFinder.h"
+#include "Vector.h"
+
+#include <cstddef>
+
+/// @brief A new weight of an existing edge.
+struct WeightUpdate
+{
+    int nodeX;  ///< One end of the edge.
+    int nodeY;  ///< The other end of the edge.
+    int weight; ///< The new weight, never 0 (that would remove the edge).
+};
+
+/// @brief Re-ranks a search in progress after some edge weights changed.
+///
+/// The search spaces of the frontier together with the trees emitted so
+/// far cover every spanning tree exactly once, whatever the weights are.
+/// So the search doesn't have to start over: every emitted tree goes back
+/// into the frontier as a space holding only itself, and the tree of
+/// every space is repaired for the new weights. A space is only touched
+/// by a change that can alter its tree, a free tree edge getting heavier
+/// or a free edge outside the tree getting lighter. Each such change
+/// costs at most one edge swap. Then the enumeration starts over from
+/// the first tree under the new weights.
+class Reweighting
+{
+public:
+    /// @brief What the repair did.
+    struct Report
+    {
+        size_t partitions = 0; ///< Spaces in the re-ranked frontier, emitted trees included.
+        size_t repaired = 0;   ///< Spaces whose tree changed.
+        size_t swaps = 0;      ///< Edge swaps done.
+    };
+
+    /// @brief Applies weight changes to the graph and to the search of it.
+    /// @param g The graph the search belongs to.
+    /// @param updates The changes, applied in order.
+    /// @param state The search, its frontier is re-ranked and its output restarts.
+    ///              It must not be bounded by SolveOptions::partitionLimit.
+    /// @param emitted The trees the search emitted so far, all of them, in any order.
+    /// @param report Receives what the repair did, if not null.
+    /// @return The reweighted graph, to be searched from now on.
+    /// @throws std::runtime_error if an update names a missing edge or the state can't be re-ranked.
+    [[nodiscard]]
+    static Graph Apply(
+        const Graph& g,
+        const Vector<WeightUpdate>& updates,
+        SolveState& state,
+        const Vector<Partition>& emitted,
+        Report* report = nullptr
+    );
+
+private:
+    /// @brief Restores the tree of a space after one edge changed its weight.
+    /// @param p The space, its tree is minimal for the weights before the change.
+    /// @param edge The index of the changed edge.
+    /// @param weight The new weight of the edge.
+    /// @param g The graph, only its vertices and endpoints are used.
+    /// @param weights The weights before the change.
+    /// @return `true` if an edge was swapped.
+    static bool repair(
+        Partition& p,
+        int edge,
+        int weight,
+        const Graph& g,
+        const Vector<int>& weights
+    );
+};
+
+#endif // __REWEIGHTING_H
@@ -0,0 +1,32 @@
+#include "SolveStats.h"
+
+void SolveStats::WriteJson(std::ostream& os, double seconds, const PerfReport* perf) const
+{
+    os << "{\n"
+       << "  \"seconds\": " << seconds << ",\n"
+       << "  \"trees_per_second\": " << (seconds > 0 ? emitted / seconds : 0) << ",\n"
+       << "  \"popped\": " << popped << ",\n"
+       << "  \"emitted\": " << emitted << ",\n"
+       << "  \"create_partition_calls\": " << createPartitionCalls << ",\n"
+       << "  \"prim_calls\": " << primCalls << ",\n"
+       << "  \"infeasible\": " << infeasible << ",\n"
+       << "  \"pruned\": " << pruned << ",\n"
+       << "  \"edges_scanned\": " << edgesScanned << ",\n"
+       << "  \"regenerated\": " << regenerated << ",\n"
+       << "  \"partition_bytes\": " << partitionBytes << ",\n"
+       << "  \"frontier_size\": " << frontierSize << ",\n"
+       << "  \"frontier_high_water\": " << frontierHighWater << ",\n"
+       << "  \"cost_levels\": [";
+
+    for (size_t i = 0; i < costLevels.size(); ++i)
+        os << (i ? ", " : "") << "[" << costLevels[i].first << ", " << costLevels[i].second << "]";
+
+    os << "]";
+
+    if (perf) {
+        os << ",\n  \"perf\": ";
+        perf->WriteJson(os, 2);
+    }
+
+    os << "\n}\n";
+}
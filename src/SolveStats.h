@@ -0,0 +1,57 @@
+#ifndef __SOLVE_STATS_H
+#define __SOLVE_STATS_H
+
+#include "PerfCounters.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/// @brief Counts a statistic of SpanningTreesFinder::Solve if they are collected.
+///
+/// `SOLVE_STAT(stats, popped++)` bumps the counter when `stats` isn't null.
+/// Building with KTHMST_NO_STATS defined (`make STATS=0`) compiles every
+/// counter out, the search then runs without a single extra instruction.
+#ifdef KTHMST_NO_STATS
+#define SOLVE_STAT(stats, update) ((void)0)
+#else
+#define SOLVE_STAT(stats, update) do { if (stats) { (stats)->update; } } while (0)
+#endif
+
+/// @brief What SpanningTreesFinder::Solve went through, filled in on request.
+struct SolveStats
+{
+    uint64_t popped = 0;               ///< Partitions taken from the frontier.
+    uint64_t emitted = 0;              ///< Trees handed to the callback.
+    uint64_t createPartitionCalls = 0; ///< Trees computed for search spaces.
+    uint64_t primCalls = 0;            ///< Of them by Prim's algorithm, the rest by Kruskal's.
+    uint64_t infeasible = 0;           ///< Search spaces without any spanning tree.
+    uint64_t pruned = 0;               ///< Search spaces skipped for excluding a bridge.
+    uint64_t edgesScanned = 0;         ///< Edges looked at by Kruskal's, matrix entries by Prim's.
+    uint64_t regenerated = 0;          ///< Dropped partitions rebuilt.
+    uint64_t partitionBytes = 0;       ///< Memory allocated for partitions in total.
+    size_t frontierSize = 0;           ///< Partitions waiting in the frontier right now.
+    size_t frontierHighWater = 0;      ///< Most partitions waiting in the frontier at once.
+
+    /// Trees emitted per cost, in increasing order of cost.
+    std::vector<std::pair<int, uint64_t>> costLevels;
+
+    /// @brief Counts an emitted tree of the given cost, costs come in non-decreasing order.
+    void CountTree(int cost)
+    {
+        emitted++;
+        if (costLevels.empty() || costLevels.back().first != cost)
+            costLevels.emplace_back(cost, 0);
+        costLevels.back().second++;
+    }
+
+    /// @brief Writes the statistics as a JSON document.
+    /// @param os The output stream.
+    /// @param seconds Duration of the search, reported along with the rates.
+    /// @param perf Hardware counters of the run, left out if null.
+    void WriteJson(std::ostream& os, double seconds, const PerfReport* perf = nullptr) const;
+};
+
+#endif // __SOLVE_STATS_H
@@ -1,31 +1,38 @@
 #include "SpanningTreesFinder.h"
+#include "BridgeFinder.h"
 #include "Partition.h"
 #include "Graph.h"
 #include "DisjointSet.h"
-#include "BinaryHeap.h"
+#include "PartitionQueue.h"
+#include "Checkpoint.h"
+#include "PerfCounters.h"
+#include "Trace.h"
+#include "TreeVerifier.h"
 #include "Matrix.h"
+#include "MatrixParser.h"
+#include "OutputBuffer.h"
+#include "ResultFile.h"
 
 #include <cassert>
+#include <climits>
+#include <chrono>
 #include <iostream>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 
 Matrix<int> 
 SpanningTreesFinder::ReadAdjacencyMatrix(std::ifstream& inputStream)
 {
-    size_t numOfVert = 0;
-    inputStream >> numOfVert;
-
-    // Read in the matrix
-    const auto elems = new int[numOfVert * numOfVert];
-    for (size_t i = 0; i < numOfVert * numOfVert; ++i)
-        inputStream >> elems[i];
-    
-    auto adjMat = Matrix<int>(numOfVert, numOfVert, elems);
+    return MatrixParser::Read(inputStream);
+}
 
-    return adjMat;
+Graph
+SpanningTreesFinder::ReadGraph(const std::string& path)
+{
+    return MatrixParser::ReadGraph(path);
 }
 
 Vector<Edge>
@@ -61,96 +68,331 @@ SpanningTreesFinder::Solve(const Graph& g)
     // Storage for the MSTs.
     Vector<Partition> spanningTrees;
 
-    // Shared among all iterations, stores found vertices.
-    // Used in the createPartition function for Kruskal's.
-    DisjointSet<int> disjointSet(g.VertexCount());
+    // Trees already come out ordered by their cost.
+    Solve(g, [&spanningTrees](const Partition& p) {
+        spanningTrees.PushBack(p);
+        return true;
+    });
+
+    return spanningTrees;
+}
+
+/// Finds all the spanning trees and hands
+/// them to the callback ascendingly by 
+/// their cost.
+void
+SpanningTreesFinder::Solve(const Graph& g, const TreeCallback& onTree, const SolveOptions& options)
+{
+    SolveState state(g, options);
+    Solve(g, state, onTree, options);
+}
+
+SolveState::SolveState(const Graph& g, const SolveOptions& options)
+: disjointSet(g.VertexCount()),
+  kernel(options.kernel),
+  partitions(options.memoryLimit, options.spillDirectory, options.partitionLimit)
+{
+    Reset(g);
+}
+
+void SolveState::Reset(const Graph& g)
+{
+    while (!partitions.Empty())
+        delete partitions.Poll();
+
+    RebuildKernels(g);
+
+    emitted = 0;
+    started = false;
+}
+
+void SolveState::RebuildKernels(const Graph& g)
+{
+    if (disjointSet.elemCount != g.VertexCount())
+        disjointSet = DisjointSet<int>(g.VertexCount());
+
+    // Worth its matrix only if it can win even against Kruskal's longest scans.
+    const bool dense = kernel == SolveOptions::PRIM ||
+        (kernel == SolveOptions::AUTO && DensePrim::Faster(g.VertexCount(), g.EdgeCount(), 1.0));
+    prim = dense ? std::make_unique<DensePrim>(g) : nullptr;
+}
+
+Partition* SolveState::CreatePartition(
+    const Partition::Choices& choices, const Graph& g, const size_t depth, SolveStats* stats)
+{
+    const bool usePrim = prim &&
+        (kernel == SolveOptions::PRIM || DensePrim::Faster(g.VertexCount(), g.EdgeCount(), (double)depth / g.EdgeCount()));
+
+    return usePrim ? prim->CreatePartition(choices, stats)
+                   : SpanningTreesFinder::CreatePartition(choices, g, disjointSet, stats);
+}
 
-    // Ordinary binary heap to store the partitions
+/// Continues the search of the state,
+/// handing the trees to the callback.
+void
+SpanningTreesFinder::Solve(
+    const Graph& g, SolveState& state, const TreeCallback& onTree, const SolveOptions& options)
+{
+    // Priority queue to store the partitions
     // (search spaces - holds info about the spanning tree)
     // in a way, so that its always ready to serve the partition
-    // with the least mstCost.
-    auto partCmp = [](const Partition* l, const Partition* r) {
-        return l->Less(*r);
-    };
+    // with the least mstCost. Over the memory limit it spills to disk.
+    PartitionQueue& partitions = state.partitions;
 
-    auto partitions = BinaryHeap<Partition*, decltype(partCmp)>(partCmp);
+    // Number of trees handed to the callback so far.
+    int& emitted = state.emitted;
 
-    // Initial state is choice where all the edges all not assessed.
-    const Vector<int> initChoices(g.EdgeCount(), Partition::NOT_ASSESSED);
+    if (!state.started) {
+        PerfScope initial(options.perf, PerfReport::INITIAL_MST);
+        TraceScope initialSpan(options.resumePath.empty() ? "initial mst" : "resume");
 
-    // Find the actual MST, put it in the storage of STs
-    Partition* mst = CreatePartition(initChoices, g, disjointSet);
+        if (!options.resumePath.empty()) {
+            // Pick up the frontier where the previous run left it
+            emitted = Checkpoint::Read(options.resumePath, g, partitions);
+        } else {
+            // Initial state is choice where all the edges all not assessed.
+            const Partition::Choices initChoices(g.EdgeCount(), Partition::NOT_ASSESSED);
 
-    // Throws if the graph is not connected -> no spanning tree is possible
-    if (mst == nullptr)
-        throw std::runtime_error("The graph is not connected. Spanning tree not possible.");
+            // Find the actual MST, it's the first one to leave the heap
+            Partition* mst = state.CreatePartition(initChoices, g, g.EdgeCount(), options.stats);
 
-    spanningTrees.PushBack(*mst);
-    partitions.Insert(mst);
+            // Throws if the graph is not connected -> no spanning tree is possible
+            if (mst == nullptr)
+                throw std::runtime_error("The graph is not connected. Spanning tree not possible.");
 
-    // size_t spanningTreeCount = 1;
+            partitions.Insert(mst);
+        }
+
+        state.started = true;
+    }
+
+    // Bridges of a space are in all of its trees, they are never excluded.
+    // Finding them takes about a Kruskal's pass, it pays off only where
+    // exclusions often disconnect the space. How often they did over the
+    // last expansions decides, the counts decay as the search goes deeper.
+    BridgeFinder bridges(g);
+    size_t recentExpansions = 0, recentDisconnected = 0;
+
+    const bool checkpoints = !options.checkpointPath.empty();
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+
+    PerfScope expansion(options.perf, PerfReport::EXPANSION);
+
+    // Spans of single expansions would swamp the trace and overwrite the
+    // phases before them, they are grouped, polls and inserts included.
+    const size_t TRACE_BATCH = 256;
+    size_t batchSize = 0;
+    uint64_t batchBegin = Tracer::Enabled() ? Tracer::Now() : 0;
 
     // while all the search spaces still weren't
     // searched through, continue searching
     while (!partitions.Empty())
     {
+        if ((options.stop && *options.stop) ||
+            (options.treeLimit && (size_t)emitted >= options.treeLimit)) {
+            if (checkpoints)
+                Checkpoint::Write(options.checkpointPath, g, emitted, partitions);
+            return;
+        }
+
         // Search this partition's search space
-        const Partition* part = partitions.Poll();
+        const Partition* part;
+        {
+            PerfScope heap(options.perf, PerfReport::HEAP);
+            part = partitions.Poll();
+        }
+        SOLVE_STAT(options.stats, popped++);
+
+        // The output reached the cheapest dropped sub-space of a parent, they are all cut again
+        if (part->ghost) {
+            Regenerate(*part, g, state, options.stats);
+            delete part;
+            continue;
+        }
+
+        SOLVE_STAT(options.stats, CountTree(part->mstCost));
+
+        // A sub-space never has a cheaper MST than the space it was cut from,
+        // so the polled trees come out in non-decreasing order of cost.
+        if (!onTree(*part)) {
+            // Not handed out, so it belongs to the frontier a later call continues from
+            partitions.Insert(const_cast<Partition*>(part));
+            if (checkpoints)
+                Checkpoint::Write(options.checkpointPath, g, emitted, partitions);
+            return;
+        }
+
+        const int partIndex = emitted++;
+
+        // Excluding a bridge of the space would disconnect it, a sub-space
+        // can't do without them either. They are all edges of its tree.
+        const bool pruning = recentDisconnected * 2 >= recentExpansions;
+
+        // The children's trees are the part's with an edge swapped, Kruskal's scans about as far.
+        const size_t depth = part->mstEdges.Back() + 1;
+        if (pruning)
+            bridges.Find(part->choices);
+        if (++recentExpansions == 1024) {
+            recentExpansions /= 2;
+            recentDisconnected /= 2;
+        }
 
         // Make a new choice describing the search space
         // and see if a spanning tree is possible in this space
-        // If yes, add it to the mstList
+        // If yes, add it to the heap
         for (size_t x = 0; x < g.VertexCount() - 1; x++)
         {
             // Matches the first still not assessed choice
             // and evaluates this space
             if (part->choices[part->mstEdges[x]] == Partition::EdgeChoice::NOT_ASSESSED)
             {
+                // No tree left without a bridge, skip finding one
+                if (pruning && bridges.IsBridge(part->mstEdges[x])) {
+                    SOLVE_STAT(options.stats, pruned++);
+                    recentDisconnected++;
+                    continue;
+                }
+
                 // copy the choices of the previous iteration
-                Vector<int> choices(part->choices);
+                Partition::Choices choices(part->choices);
 
                 // Mark current as excluded and try a tree is possible
                 choices[part->mstEdges[x]] = Partition::EdgeChoice::EXCLUDED;
 
-                // Mark all the previous choices that had already been included
-                for (size_t y = 0; y < x; y++)
-                    choices[part->mstEdges[y]] = Partition::EdgeChoice::INCLUDED;
+                // Mark all the previous choices that had already been included,
+                // and the bridges after it, so the sub-space never tries them
+                for (size_t y = 0; y < g.VertexCount() - 1; y++)
+                    if (y < x || (pruning && y > x && bridges.IsBridge(part->mstEdges[y])))
+                        choices[part->mstEdges[y]] = Partition::EdgeChoice::INCLUDED;
 
                 // Try finding a spanning tree for this search space
-                Partition* nxt = CreatePartition(choices, g, disjointSet);
+                Partition* nxt = state.CreatePartition(choices, g, depth, options.stats);
 
                 // If the nxt pointer is NULL then no spanning tree was found
-                if (nxt == nullptr)
+                if (nxt == nullptr) {
+                    SOLVE_STAT(options.stats, infeasible++);
+                    recentDisconnected++;
                     continue;
+                }
+
+                SOLVE_STAT(options.stats, partitionBytes += PartitionQueue::Footprint(*nxt));
+
+                // Remember where it came from, its tree usually differs by an edge swap or two
+                nxt->parent = partIndex;
+
+                // A bounded search may have to rebuild the space later, and so may
+                // one resumed from the checkpoints, which store the chains. The chain
+                // starts at the MST, a space of a checkpoint without chains has none
+                // and neither have its sub-spaces, they are never dropped.
+                if ((options.partitionLimit || checkpoints) && (part->branch || partIndex == 0))
+                    nxt->branch = std::make_shared<const Branch>(part->mstEdges[x], part->branch);
 
                 // Otherwise insert the newly found spanning tree into the heap
-                // and add it to the list of valid spanning trees
+                PerfScope heap(options.perf, PerfReport::HEAP);
                 partitions.Insert(nxt);
-                spanningTrees.PushBack(*nxt);
-
-                // std::cout << spanningTreeCount++ << " " << partitions.Size() << "\n";
             }
         }
 
         // The partition is not needed anymore as this search space was already searched through
         delete part;
+
+        if (Tracer::Enabled() && ++batchSize == TRACE_BATCH) {
+            const uint64_t now = Tracer::Now();
+            Tracer::Record("expand", batchBegin, now);
+            batchBegin = now;
+            batchSize = 0;
+        }
+
+        SOLVE_STAT(options.stats, frontierSize = partitions.Size());
+        SOLVE_STAT(options.stats, frontierHighWater = std::max(options.stats->frontierHighWater, partitions.Size()));
+
+        // Between two iterations the frontier is all there is to the search
+        if (checkpoints) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - lastCheckpoint >= std::chrono::seconds(options.checkpointInterval)) {
+                Checkpoint::Write(options.checkpointPath, g, emitted, partitions);
+                lastCheckpoint = now;
+            }
+        }
     }
 
-    // sort them by mstWeight and return the list (vector)
-    std::ranges::sort(spanningTrees,
-        [](const Partition& l, const Partition& r){ return l.mstCost < r.mstCost; });
+    if (Tracer::Enabled() && batchSize > 0)
+        Tracer::Record("expand", batchBegin, Tracer::Now());
+
+    // An empty frontier tells a resumed run there's nothing left
+    if (checkpoints)
+        Checkpoint::Write(options.checkpointPath, g, emitted, partitions);
 
-    return spanningTrees;
 }
 
 
 
+void
+SpanningTreesFinder::Regenerate(
+    const Partition& ghost, const Graph& g, SolveState& state, SolveStats* stats)
+{
+    // The chain is linked from the parent up, the replay goes from the MST down.
+    Vector<int> path;
+    for (const Branch* b = ghost.branch.get(); b != nullptr; b = b->parent.get())
+        path.PushBack(b->edge);
+
+    // Same cut as in Solve: the tree edges before the branch edge are included
+    auto cut = [](Partition::Choices& choices, const Partition& space, const int edge) {
+        for (const int e : space.mstEdges) {
+            if (e == edge)
+                break;
+            choices[e] = Partition::EdgeChoice::INCLUDED;
+        }
+        choices[edge] = Partition::EdgeChoice::EXCLUDED;
+    };
+
+    Partition::Choices choices(g.EdgeCount(), Partition::NOT_ASSESSED);
+    size_t depth = g.EdgeCount();
+    const Partition* parent = nullptr;
+
+    for (size_t i = path.Size() + 1; i-- > 0; )
+    {
+        delete parent;
+        parent = state.CreatePartition(choices, g, depth, stats);
+        if (parent == nullptr)
+            throw std::runtime_error("Can't regenerate a dropped partition");
+
+        depth = parent->mstEdges.Back() + 1;
+        if (i > 0)
+            cut(choices, *parent, path[i - 1]);
+    }
+
+    // The dropped sub-spaces go back to the queue, the cheapest one is next.
+    int cheapest = INT_MAX;
+    for (const int edge : ghost.mstEdges) {
+        Partition::Choices sub(choices);
+        cut(sub, *parent, edge);
+
+        Partition* p = state.CreatePartition(sub, g, depth, stats);
+        if (p == nullptr) {
+            delete parent;
+            throw std::runtime_error("Can't regenerate a dropped partition");
+        }
+
+        p->parent = ghost.parent;
+        p->branch = std::make_shared<const Branch>(edge, ghost.branch);
+        cheapest = std::min(cheapest, p->mstCost);
+        state.partitions.Insert(p);
+        SOLVE_STAT(stats, regenerated++);
+    }
+    delete parent;
+
+    if (cheapest != ghost.mstCost)
+        throw std::runtime_error("Can't regenerate a dropped partition");
+}
+
 /// Finds the MST of the given search space.
 /// If no tree is possible to construct given 
 /// the search space, nullptr is returned.
 /// Is using Kruskal's algorithm.
 Partition* 
-SpanningTreesFinder::CreatePartition(const Vector<int>& choices, const Graph& g, DisjointSet<int>& ds)
+SpanningTreesFinder::CreatePartition(
+    const Partition::Choices& choices, const Graph& g, DisjointSet<int>& ds, [[maybe_unused]] SolveStats* stats)
 {
     ds.Reset(); // Resets the disjoint set, reusing the same memory again.
     
@@ -175,7 +417,8 @@ SpanningTreesFinder::CreatePartition(const Vector<int>& choices, const Graph& g,
         }
     }
 
-    for (size_t i = 0; i < g.EdgeCount(); i++)
+    size_t i = 0;
+    for (; i < g.EdgeCount(); i++)
     {
         // If the graph is already connected then no additional edge is needed, break out
         if (ds.numberOfComponents == 1) 
@@ -194,6 +437,10 @@ SpanningTreesFinder::CreatePartition(const Vector<int>& choices, const Graph& g,
         }
     }
 
+    // Both passes together: all the edges, then the ones up to the connecting one
+    SOLVE_STAT(stats, createPartitionCalls++);
+    SOLVE_STAT(stats, edgesScanned += g.EdgeCount() + i);
+
     // If no spanning tree is possible in this search space
     // toss this partition away as it's not possible for 
     // this search spaces to contain any spanning tree.
@@ -211,137 +458,106 @@ SpanningTreesFinder::CreatePartition(const Vector<int>& choices, const Graph& g,
     return new Partition(choices, mstCost, mstEdges);
 }
 
-// Test for duplicate trees.
-void SpanningTreesFinder::TestDuplicates(const Vector<Partition>& kts) {
-    using std::cout;
-    Vector<Partition> ks = kts;
-    cout << "INFO: Testing for duplicities...\n";
-
-    // presort
-    std::ranges::sort(ks,
-        [](const Partition& l, const Partition& r) {
-            return l.choices == r.choices; // choices should all be unique
-        }
-    );
-
-    int dupCount = 0;
+// Report the duplicate trees.
+void SpanningTreesFinder::ReportDuplicates(const Vector<Partition>& duplicates, std::ostream& os) {
+    os << "INFO: Testing for duplicities...\n";
 
-    // show that every tree is unique
-    for (size_t i = 0; i < ks.Size() - 1; i++) {
-        if (ks[i].choices == ks[i+1].choices) {
-            cout << "Found-duplicate (" << ++dupCount << ")\n";
-            cout << ks[i] << "\n" << ks[i+1] << "\n";
-        }
+    if (duplicates.Empty()) {
+        os << "DONE: Found none\n";
+        return;
     }
 
-    if (dupCount == 0) {
-        cout << "DONE: Found none\n";
-        return;
+    for (size_t i = 0; i < duplicates.Size(); ++i) {
+        os << "Found-duplicate (" << i + 1 << ")\n";
+        os << duplicates[i] << "\n";
     }
-    
-    cout << "DONE: Found " << dupCount << " dups\n";
+
+    os << "DONE: Found " << duplicates.Size() << " dups\n";
 }
 
 /// Test that graphs in ks are all trees, 
 /// meaning they have no cycles.
-void SpanningTreesFinder::TestCycles(const Vector<Partition>& ks, const Graph& g) {
-    using std::cout;
-
+void SpanningTreesFinder::TestCycles(const Vector<Partition>& ks, const Graph& g, std::ostream& os) {
     // show that all "trees" are actual trees
-    cout << "INFO: Testing for cycles...\n";
-    int nonTreeCount=0;
-
-    DisjointSet<int> ds(g.VertexCount());
+    os << "INFO: Testing for cycles...\n";
 
+    TreeVerifier verifier(g);
     for (const Partition& k : ks)
-    {
-        // each edge addition should yield a new reachable vertex
-        // if its already included, then by adding this edge a cycle is intorduced
-        ds.Reset();
-        for (const int ke : k.mstEdges)
-        {
-            const Edge e = g.Edges()[ke];
-            if (ds.NodesConnected(e.nodeX, e.nodeY)) {
-                std::cout << "Not-a-tree " << k.ToString() << "\n";
-                nonTreeCount++;
-                break;
-            }
-            ds.Unify(e.nodeX, e.nodeY);
-        }
-    }
+        verifier.Submit(k);
 
-    if (!nonTreeCount) {
-        cout << "DONE: Found none\n";
-        return;
-    }
-    
-    cout << "DONE: Found " << nonTreeCount << " non-trees\n";
+    TreeVerifier::PrintReport(os, verifier.Finish());
 }
 
-// helper function for the writeToHTML
-void writeOnlyKth(
-    std::ofstream& output,
-    const Graph& graph,
-    const Vector<Partition>& ks
-)
+void SpanningTreesFinder::WriteResultHeader(OutputBuffer& output, const Graph& g)
 {
-    int kCost = 0;
-    for (const Partition& k : ks)
-    {
-        if (kCost < k.mstCost) 
-        {
-            output << "[\n";
-            for (const int i : k.mstEdges)
-            {
-                const Edge& e = graph.Edges()[i];
-                output << "{ source: " 
-                        << e.nodeX 
-                        << ", target: "
-                        << e.nodeY 
-                        << ", cost: "
-                        << e.weight
-                        << "},\n";
-            }
-            output << "],\n";
-            kCost = k.mstCost;
-        }
-    }
+    WriteResultHeader(output, g.VertexCount(), g.EdgeCount());
 }
 
-// helper function for the writeToHTML
-void writeAllTrees(
-    std::ofstream& output,
-    const Graph& graph,
-    const Vector<Partition>& ks
-)
+void SpanningTreesFinder::WriteResultHeader(OutputBuffer& output, const size_t vertexCount, const size_t edgeCount)
 {
-    for (const Partition& k : ks)
-    {
-        output << "[\n";
-        for (const int i : k.mstEdges)
-        {
-            const Edge& e = graph.Edges()[i];
-            output << "{ source: " 
-                    << e.nodeX 
-                    << ", target: "
-                    << e.nodeY 
-                    << ", cost: "
-                    << e.weight
-                    << "},\n";
-        }
-        output << "],\n";
+    output << "# kthmst " << vertexCount << ' ' << edgeCount << '\n';
+}
+
+void SpanningTreesFinder::WriteResultLine(OutputBuffer& output, const Partition& p)
+{
+    output << p.mstCost << ':';
+    for (const int e : p.mstEdges)
+        output << ' ' << e;
+    output << '\n';
+}
+
+bool SpanningTreesFinder::ReadResultHeader(std::istream& input, size_t& vertexCount, size_t& edgeCount)
+{
+    std::string hash, magic;
+    input >> hash >> magic >> vertexCount >> edgeCount;
+    return input && hash == "#" && magic == "kthmst";
+}
+
+bool SpanningTreesFinder::ReadResultLine(std::istream& input, Partition& p)
+{
+    std::string line;
+    if (!std::getline(input, line))
+        return false;
+
+    // Skip the rest of the header and empty lines.
+    while (line.empty() || line[0] == '#') {
+        if (!std::getline(input, line))
+            return false;
     }
+
+    std::istringstream ss(line);
+    char colon = 0;
+    p.Reset();
+    ss >> p.mstCost >> colon;
+
+    if (!ss || colon != ':')
+        throw std::runtime_error("Malformed result line: " + line);
+
+    for (int e; ss >> e; )
+        p.mstEdges.PushBack(e);
+
+    return true;
+}
+
+std::string SpanningTreesFinder::HtmlDataPath(const std::string& outputPath)
+{
+    return outputPath.substr(0, outputPath.rfind('.')) + ".bin";
 }
 
 void SpanningTreesFinder::WriteToHtml(
     const char* outputPath,
     const char* headPath, 
     const char* tailPath, 
-    const int mode,
-    const Graph& g,
-    const Vector<Partition>& ks
+    const Graph& g
 )
 {
+    TraceScope span("html");
+
+    // The page only holds the edge table and fetches
+    // the trees page by page as they are scrolled into view.
+    const std::string dataPath = HtmlDataPath(outputPath);
+    const std::string dataName = dataPath.substr(dataPath.rfind('/') + 1);
+
     std::string line;
     std::ofstream output(outputPath);
 
@@ -353,21 +569,14 @@ void SpanningTreesFinder::WriteToHtml(
         output << line << "\n";
     head.close();
 
-	output << "<body></body>\n";
+	output << "<body>\n";
     output << "<script>\n";
     output << "const vertexCount = " << g.VertexCount() << ";\n";
-    output << "const trees = [\n";
+    output << "const dataFile = \"" << dataName << "\";\n";
+    output << "const edgeTable = [\n";
 
-    switch (mode) {
-        case 0:
-        case 1:
-            writeOnlyKth(output, g, ks);
-            break;
-        case 2:
-            writeAllTrees(output, g, ks);
-            break;
-        default: break;
-    }
+    for (const Edge& e : g.Edges())
+        output << "[" << e.nodeX << "," << e.nodeY << "," << e.weight << "],\n";
 
     output << "];\n";
     output << "</script>\n";
@@ -377,6 +586,7 @@ void SpanningTreesFinder::WriteToHtml(
         output << line << "\n";
     tail.close();
 
+   	output << "</body>\n";
    	output << "</html>\n";
 
 
@@ -386,19 +596,25 @@ void SpanningTreesFinder::WriteToHtml(
 
 void SpanningTreesFinder::PrintTrees(const Vector<Partition>& ks, const Graph& graph, const int mode)
 {
-    std::cout << "Found " << ks.Size() << " trees, from cost of "
-         << ks.Front().mstCost << " to " << ks.Back().mstCost << "\n";
+    TraceScope span("print");
+
+    // The compact listing is meant to be piped into other tools,
+    // the summary must not get mixed into it.
+    std::ostream& log = mode == 3 ? std::cerr : std::cout;
+    PrintSummary(log, ks.Size(), ks.Empty() ? 0 : ks.Front().mstCost, ks.Empty() ? 0 : ks.Back().mstCost);
+    log.flush();
+
+    // One big buffer for all the trees, flushed to stdout in large blocks.
+    OutputBuffer out(stdout);
 
     switch (mode) {
         case 1: {
             // print only kth trees (random kth)
-            int k = 0;
-            int kCost = 0;
+            size_t k = 0;
             for (size_t i = 0; i < ks.Size(); ++i) {
-                if (kCost < ks[i].mstCost) {
-                    std::cout << "[" << k << "][" << i << "]\n";
-                    std::cout << ks[i].ToString(graph) << "\n";
-                    kCost = ks[i].mstCost;
+                if (i == 0 || ks[i - 1].mstCost < ks[i].mstCost) {
+                    out << '[' << k << "][" << i << "]\n";
+                    WriteTree(out, ks[i], graph);
                     k++;
                 }
             }
@@ -407,11 +623,45 @@ void SpanningTreesFinder::PrintTrees(const Vector<Partition>& ks, const Graph& g
             // if the third argument is 2, 
             // then print every trees to the console
             for (size_t i = 0; i < ks.Size(); ++i) {
-                std::cout << "[" << i << "]\n";
-                std::cout << ks[i].ToString(graph) << "\n";
+                out << '[' << i << "]\n";
+                WriteTree(out, ks[i], graph);
             }
         } break;
+        case 3: {
+            // one line per tree, the same as the text result file
+            WriteResultHeader(out, graph);
+            for (const Partition& k : ks)
+                WriteResultLine(out, k);
+        } break;
         default: break;
     }
 }
 
+void SpanningTreesFinder::PrintSummary(std::ostream& os, const size_t count, const int firstCost, const int lastCost)
+{
+    // A resumed search may have nothing left to find.
+    if (count == 0)
+        os << "Found 0 trees\n";
+    else
+        os << "Found " << count << " trees, from cost of " << firstCost << " to " << lastCost << "\n";
+}
+
+void SpanningTreesFinder::WriteTree(OutputBuffer& out, const Partition& p, const Graph& g)
+{
+    // Same layout as Partition::ToString(const Graph&).
+    out << "(\n  choices = [ ";
+    for (const int c : p.choices)
+        out << c << ' ';
+
+    out << "]\n  indices = [ ";
+    for (const int e : p.mstEdges)
+        out << e << ' ';
+
+    out << "]\n    edges = [ ";
+    for (const int e : p.mstEdges) {
+        const Edge& edge = g.Edges()[e];
+        out << '(' << edge.nodeX << '.' << edge.nodeY << '|' << edge.weight << ") ";
+    }
+
+    out << "]\n     cost = " << p.mstCost << "\n)\n";
+}
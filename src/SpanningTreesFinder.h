@@ -4,11 +4,126 @@
 #include "Edge.h"
 #include "Matrix.h"
 #include "Partition.h"
+#include "DensePrim.h"
 #include "DisjointSet.h"
+#include "OutputBuffer.h"
+#include "PartitionQueue.h"
+#include "ResultFile.h"
+#include "PerfCounters.h"
+#include "SolveStats.h"
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <memory>
 #include <istream>
+#include <string>
 
 #include "Vector.h"
 
+/// @brief Tuning knobs of SpanningTreesFinder::Solve.
+struct SolveOptions
+{
+    /// Bytes of unexpanded partitions kept in memory, the rest is spilled
+    /// to disk. 0 keeps everything in memory.
+    size_t memoryLimit = 0;
+
+    /// Directory of the spilled partitions, empty for the system temp directory.
+    std::string spillDirectory;
+
+    /// Unexpanded partitions kept in full, the most expensive ones over it
+    /// are dropped and regenerated once the output reaches their cost.
+    /// 0 keeps all of them.
+    size_t partitionLimit = 0;
+
+    /// File the state of the search is periodically saved to, empty for none.
+    /// It's also written when the enumeration stops early or finishes. The
+    /// partitions keep their branch chains then, so a resumed search can be
+    /// bounded by partitionLimit.
+    std::string checkpointPath;
+
+    /// Seconds between two checkpoints.
+    unsigned checkpointInterval = 60;
+
+    /// Checkpoint to continue from instead of starting with the MST, empty for none.
+    std::string resumePath;
+
+    /// Checked before every tree, once set the search writes its checkpoint
+    /// and stops. Unlike stopping from the callback, a run resumed from it
+    /// breaks ties between equal trees the same way as an uninterrupted run.
+    const volatile std::sig_atomic_t* stop = nullptr;
+
+    /// Receives the statistics of the search, null to skip collecting them.
+    /// They are updated as the search goes, so the callback may report them.
+    SolveStats* stats = nullptr;
+
+    /// Hardware counters charged per phase of the search, null for none.
+    PerfCounters* perf = nullptr;
+
+    /// Trees emitted in total (earlier calls on the same state included)
+    /// after which the search stops, 0 for all of them. It stops before
+    /// polling the next tree, so a later call continues exactly where it
+    /// left off, ties included.
+    size_t treeLimit = 0;
+
+    /// How the tree of a search space is found.
+    enum Kernel
+    {
+        AUTO,    ///< Prim's on dense graphs when it's expected to be faster, see DensePrim::Faster.
+        KRUSKAL, ///< Always Kruskal's over the sorted edges.
+        PRIM     ///< Always Prim's over the adjacency matrix.
+    };
+
+    /// Both kernels find the same trees, only the speed differs.
+    Kernel kernel = AUTO;
+};
+
+/// @brief A search in progress, lets SpanningTreesFinder::Solve continue where an earlier call stopped.
+struct SolveState
+{
+    /// @brief Creates a search that hasn't started yet.
+    /// @param g The graph to search, only its size is used here.
+    /// @param options Memory budget of the frontier, the same options must be passed to Solve.
+    explicit SolveState(const Graph& g, const SolveOptions& options = SolveOptions());
+
+    SolveState(const SolveState&) = delete;
+    SolveState& operator=(const SolveState&) = delete;
+
+    /// @brief Drops the search, keeping the memory for a search of another graph.
+    /// @param g The graph to search next.
+    void Reset(const Graph& g);
+
+    /// @brief Rebuilds the kernels for another graph, keeping the search.
+    ///
+    /// Reset does it as well, a search whose graph changes under it (see
+    /// Reweighting::Apply) has to call it alone.
+    /// @param g The graph the search continues on.
+    void RebuildKernels(const Graph& g);
+
+    /// @brief Finds the MST of a search space with the faster of the two kernels.
+    ///
+    /// Kruskal's scans the edges up to the last one of the tree. A child
+    /// space's tree is its parent's with an edge swapped, so the parent's
+    /// last edge predicts the scan, see DensePrim::Faster.
+    /// @param choices A Partition::EdgeChoice per edge.
+    /// @param g The graph of the search.
+    /// @param depth Edges Kruskal's is expected to scan.
+    /// @param stats Counts the call and the scanned edges, if not null.
+    /// @return The partition with its tree, or nullptr if the space has no spanning tree.
+    [[nodiscard]]
+    Partition* CreatePartition(const Partition::Choices& choices, const Graph& g, size_t depth, SolveStats* stats);
+
+    DisjointSet<int> disjointSet;    ///< Scratch space of Kruskal's.
+    std::unique_ptr<DensePrim> prim; ///< Prim's kernel, only for a graph dense enough to use it.
+    SolveOptions::Kernel kernel;     ///< Which kernels may be used.
+    PartitionQueue partitions;       ///< The frontier, unexpanded search spaces.
+    int emitted = 0;                 ///< Trees handed to the callbacks so far.
+    bool started = false;            ///< The first space is in the frontier (or the checkpoint read).
+
+    /// @brief Checks if every tree was emitted.
+    [[nodiscard]]
+    bool Finished() const { return started && partitions.Empty(); }
+};
+
 /// @brief A utility class for performing various graph-related operations.
 /// 
 /// The Helper class provides static methods to read adjacency matrices,
@@ -17,30 +132,20 @@
 class SpanningTreesFinder
 {
 public:
-    /// @brief Writes all found trees to a specified output stream.
-    /// 
-    /// This method outputs the details of each tree found in the provided 
-    /// graph along with the corresponding partition information.
-    /// @param output The output stream to write to.
-    /// @param graph The graph containing the edges and vertices.
-    /// @param ks A vector of partitions representing the trees.
-    static void WriteAllTrees(
-        std::ofstream& output, 
-        const Graph& graph, 
-        const Vector<Partition>& ks
-    );
+    /// @brief Receives the spanning trees as they are found.
+    ///
+    /// The callback is invoked once per tree, in non-decreasing order of cost.
+    /// Returning `false` stops the enumeration.
+    using TreeCallback = std::function<bool(const Partition&)>;
 
-    /// @brief Writes only the k-th tree to a specified output stream.
-    /// 
-    /// This method outputs the details of the k-th tree based on its cost.
-    /// @param output The output stream to write to.
-    /// @param graph The graph containing the edges and vertices.
-    /// @param ks A vector of partitions representing the trees.
-    static void WriteOnlyKth(
-        std::ofstream& output, 
-        const Graph& graph, 
-        const Vector<Partition>& ks
-    );
+    /// @brief Gives the path of the HTML viewer's binary sidecar.
+    ///
+    /// The trees go into a binary result file next to the page, same name
+    /// with `.bin` (treeees.html -> treeees.bin), appended as they are found.
+    /// @param outputPath The path to the HTML page.
+    /// @return The path to the sidecar.
+    [[nodiscard]]
+    static std::string HtmlDataPath(const std::string& outputPath);
 
     /// @brief Reads an adjacency matrix from an input stream.
     /// 
@@ -50,6 +155,16 @@ public:
     [[nodiscard]]
     static Matrix<int> ReadAdjacencyMatrix(std::ifstream& inputStream);
 
+    /// @brief Reads the graph of an adjacency matrix file, see MatrixParser.
+    /// 
+    /// The file is mapped into memory and parsed on all the cores, straight
+    /// into edges, the matrix itself is never held.
+    /// @param path The input file.
+    /// @return The graph, equal to Graph(const Matrix<int>&) of the matrix.
+    /// @throws std::runtime_error if the file can't be read or is malformed.
+    [[nodiscard]]
+    static Graph ReadGraph(const std::string& path);
+
     /// @brief Creates edges from an adjacency matrix.
     /// 
     /// This method generates edges based on the non-zero entries of the 
@@ -62,16 +177,38 @@ public:
     /// @brief Creates a partition of the graph based on specified choices.
     /// 
     /// This method attempts to construct a spanning tree (partition) using the 
-    /// choices provided and returns the resulting Partition object.
+    /// choices provided and returns the resulting Partition object. It runs
+    /// Kruskal's algorithm, SolveState::CreatePartition picks between it and
+    /// Prim's (DensePrim) during a search.
     /// @param choices A vector of choices that dictate which edges to include.
     /// @param g The graph from which to create the partition.
     /// @param ds The disjoint set used for cycle checking.
+    /// @param stats Counts the call and the scanned edges, if not null.
     /// @return A pointer to a Partition object, or nullptr if construction fails.
     [[nodiscard]]
     static Partition* CreatePartition(
-        const Vector<int>& choices,
+        const Partition::Choices& choices,
         const Graph& g, 
-        DisjointSet<int>& ds
+        DisjointSet<int>& ds,
+        SolveStats* stats = nullptr
+    );
+
+    /// @brief Rebuilds the search spaces a bounded search dropped from a parent.
+    /// 
+    /// Replays the branch chain of the parent from the MST down, each step
+    /// recomputes the tree of the space and cuts the next space from it.
+    /// The dropped sub-spaces are cut from the parent's tree again and
+    /// inserted into the queue of the search.
+    /// @param ghost The bound of the parent, see PartitionQueue.
+    /// @param g The graph the partitions belong to.
+    /// @param state The search, its kernels find the trees.
+    /// @param stats Counts the work of the replay, if not null.
+    /// @throws std::runtime_error if the spaces can't be rebuilt as they were.
+    static void Regenerate(
+        const Partition& ghost,
+        const Graph& g,
+        SolveState& state,
+        SolveStats* stats = nullptr
     );
 
     /// @brief Solves for all possible partitions of the graph.
@@ -83,11 +220,43 @@ public:
     [[nodiscard]]
     static Vector<Partition> Solve(const Graph& g);
 
+    /// @brief Streams all spanning trees of the graph to a callback.
+    /// 
+    /// Trees are handed over as soon as they leave the heap, ordered by 
+    /// their cost, so they can be consumed without storing all of them.
+    /// @param g The graph for which to find spanning trees.
+    /// @param onTree Callback receiving every tree, returns `false` to stop.
+    /// @param options Memory budget and other tuning of the search.
+    static void Solve(
+        const Graph& g,
+        const TreeCallback& onTree,
+        const SolveOptions& options = SolveOptions()
+    );
+
+    /// @brief Streams spanning trees of the graph, continuing an earlier search.
+    /// 
+    /// The first call on a state starts with the MST (or the checkpoint to
+    /// resume from), every further call picks up the frontier the previous
+    /// one left behind. With SolveOptions::treeLimit the calls can extend
+    /// the output in steps without ever re-solving the beginning.
+    /// @param g The graph for which to find spanning trees, the same for every call.
+    /// @param state The search to continue.
+    /// @param onTree Callback receiving every tree, returns `false` to stop.
+    /// @param options Memory budget and other tuning of the search.
+    static void Solve(
+        const Graph& g,
+        SolveState& state,
+        const TreeCallback& onTree,
+        const SolveOptions& options = SolveOptions()
+    );
+
 
     /// @brief Prints the details of the trees in the console.
     /// 
     /// This method outputs the partitions representing the trees in a 
-    /// formatted manner based on the specified printing mode.
+    /// formatted manner based on the specified printing mode. Mode 3 prints 
+    /// one compact line per tree (the text result file format) and moves 
+    /// the summary to stderr, so that the output can be piped elsewhere.
     /// @param ks A vector of partitions representing the trees.
     /// @param graph The graph for which the trees are defined.
     /// @param mode The mode of printing: different modes display different outputs.
@@ -97,41 +266,96 @@ public:
         int mode
     );
 
-    /// @brief Tests for duplicate trees within the partitions.
+    /// @brief Prints the line summing up the found trees, see PrintTrees.
+    /// @param os The output stream to write to.
+    /// @param count Number of trees found.
+    /// @param firstCost Cost of the first tree.
+    /// @param lastCost Cost of the last tree.
+    static void PrintSummary(std::ostream& os, size_t count, int firstCost, int lastCost);
+
+    /// @brief Reports the duplicate trees found during the search.
     /// 
-    /// This method checks all partitions for duplicity and reports any 
-    /// duplicates found in the console.
-    /// @param kts A vector of partitions to be checked for duplicates.
-    static void TestDuplicates(const Vector<Partition>& kts);
+    /// The trees are checked as they are found, by a DuplicateDetector fed 
+    /// from the Solve callback, only the duplicates are kept for the report.
+    /// @param duplicates The trees whose fingerprint was already seen, in the order found.
+    /// @param os The output stream for the report.
+    static void ReportDuplicates(const Vector<Partition>& duplicates, std::ostream& os = std::cout);
 
     /// @brief Tests if all partitions are valid trees (i.e., contain no cycles).
     /// 
-    /// This method checks each partition to ensure it is free of cycles and 
-    /// thus qualifies as a tree.
+    /// This method checks each partition to ensure it is free of cycles, 
+    /// spans the graph and has the cost it claims. The checks are spread 
+    /// over worker threads by the TreeVerifier.
     /// @param ks A vector of partitions representing the trees to be checked.
     /// @param g The graph associated with the partitions.
+    /// @param os The output stream for the report.
     static void TestCycles(
         const Vector<Partition>& ks,
-        const Graph& g
+        const Graph& g,
+        std::ostream& os = std::cout
     );
 
-    /// @brief Writes the content to an HTML file based on the graph and partitions.
+    /// @brief Writes the header line of a text result file.
+    /// 
+    /// The header records the vertex and edge count of the graph, so that
+    /// the file can be checked against the graph when it's read back.
+    /// @param output The output buffer to write to.
+    /// @param g The graph the trees belong to.
+    static void WriteResultHeader(OutputBuffer& output, const Graph& g);
+
+    /// @brief Writes the header line of a text result file.
+    /// @param output The output buffer to write to.
+    /// @param vertexCount The vertex count of the graph.
+    /// @param edgeCount The edge count of the graph.
+    static void WriteResultHeader(OutputBuffer& output, size_t vertexCount, size_t edgeCount);
+
+    /// @brief Writes one tree as a line of a text result file.
+    /// 
+    /// The line has the form `cost: e1 e2 ... e(n-1)`, listing the indices 
+    /// of the tree's edges.
+    /// @param output The output buffer to write to.
+    /// @param p The partition holding the tree.
+    static void WriteResultLine(OutputBuffer& output, const Partition& p);
+
+    /// @brief Writes the details of one tree in the console format.
+    /// 
+    /// Produces the same text as Partition::ToString(const Graph&), 
+    /// followed by a newline, without any intermediate strings.
+    /// @param output The output buffer to write to.
+    /// @param p The partition holding the tree.
+    /// @param g The graph the tree belongs to.
+    static void WriteTree(OutputBuffer& output, const Partition& p, const Graph& g);
+
+    /// @brief Reads the header line of a text result file.
+    /// @param input The input stream to read from.
+    /// @param vertexCount Receives the vertex count stored in the file.
+    /// @param edgeCount Receives the edge count stored in the file.
+    /// @return `false` if the stream doesn't start with a valid header.
+    static bool ReadResultHeader(std::istream& input, size_t& vertexCount, size_t& edgeCount);
+
+    /// @brief Reads the next tree from a text result file.
     /// 
-    /// This method writes a JavaScript representation of the graph and its 
-    /// partitions to an HTML file using the specified format structure.
+    /// Only the cost and edges are stored in the file, the choices of the
+    /// returned partition are left empty.
+    /// @param input The input stream to read from.
+    /// @param p Receives the tree.
+    /// @return `false` when there are no more trees.
+    static bool ReadResultLine(std::istream& input, Partition& p);
+
+    /// @brief Writes the content to an HTML file based on the graph.
+    /// 
+    /// This method writes the graph's edge table into an HTML page. The 
+    /// trees are in the sidecar at HtmlDataPath, which the page loads page 
+    /// by page while scrolling.
     /// @param outputPath The path to the output file.
     /// @param headPath The path to the HTML head content.
     /// @param tailPath The path to the HTML tail content.
-    /// @param mode The mode determining which trees to write.
     /// @param g The graph to be represented in the HTML.
-    /// @param ks A vector of partitions to write to the HTML.
     static void WriteToHtml(
         const char* outputPath, 
         const char* headPath, 
         const char* tailPath, 
-        int mode,
-        const Graph& g,
-        const Vector<Partition>& ks
+        const Graph& g
     );
 };
 
@@ -0,0 +1,55 @@
+#include "Topology.h"
+#include "BridgeFinder.h"
+#include "Partition.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+Topology::Topology(MatrixParser::EdgeList list)
+: vertexCount(list.vertexCount), edges(std::move(list.edges))
+{
+    if (vertexCount == 0 || edges.Empty())
+        throw std::runtime_error("Cannot solve for a tree with no vertices or edges");
+
+    BridgeFinder finder(Graph(vertexCount, edges));
+    if (finder.Find() != 1)
+        throw std::runtime_error("The graph is not connected. Spanning tree not possible.");
+
+    bridges = Vector<char>(edges.Size(), 0);
+    for (size_t i = 0; i < edges.Size(); ++i)
+        bridges[i] = finder.IsBridge(i);
+    bridgeCount = finder.BridgeCount();
+}
+
+Graph Topology::Weigh(const Vector<int>& weights, Vector<int>& order) const
+{
+    if (weights.Size() != edges.Size())
+        throw std::runtime_error("Expected " + std::to_string(edges.Size()) + " weights, got " +
+                                 std::to_string(weights.Size()));
+
+    order.Clear();
+    for (size_t i = 0; i < edges.Size(); ++i) {
+        if (weights[i] == 0)
+            throw std::runtime_error("Weight of edge " + std::to_string(i) + " is 0");
+        order.PushBack(i);
+    }
+
+    std::ranges::stable_sort(order, [&weights](const int l, const int r) { return weights[l] < weights[r]; });
+
+    Vector<Edge> sorted;
+    for (const int i : order)
+        sorted.EmplaceBack(edges[i].nodeX, edges[i].nodeY, weights[i]);
+
+    return Graph(vertexCount, sorted);
+}
+
+Partition::Choices Topology::InitialChoices(const Vector<int>& order) const
+{
+    Partition::Choices choices(order.Size(), Partition::NOT_ASSESSED);
+    for (size_t i = 0; i < order.Size(); ++i)
+        if (bridges[order[i]])
+            choices[i] = Partition::INCLUDED;
+    return choices;
+}
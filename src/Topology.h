@@ -0,0 +1,54 @@
+#ifndef __TOPOLOGY_H
+#define __TOPOLOGY_H
+
+#include "Edge.h"
+#include "Graph.h"
+#include "MatrixParser.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <cstddef>
+
+/// @brief The weight-independent part of a graph, shared by any number of weight vectors.
+///
+/// The edges are numbered in the order of the adjacency matrix, row by row
+/// over its upper triangle, and weight vectors list one weight per edge in
+/// this order. Connectivity and bridges are found once. A bridge is in
+/// every spanning tree, so searches of the weighted graphs start with the
+/// bridges included and never cut a space on them. A weighted graph is
+/// built straight from the edges, only the sort by weight is redone.
+class Topology
+{
+public:
+    /// @brief Analyses the edges of an adjacency matrix, its weights are ignored.
+    /// @param list The edges in the matrix order, see MatrixParser::ReadEdges.
+    /// @throws std::runtime_error if the graph has no edges or isn't connected.
+    explicit Topology(MatrixParser::EdgeList list);
+
+    [[nodiscard]] size_t VertexCount() const { return vertexCount; }      ///< |V| of the graph.
+    [[nodiscard]] size_t EdgeCount() const { return edges.Size(); }       ///< |E| of the graph.
+    [[nodiscard]] size_t BridgeCount() const { return bridgeCount; }      ///< Edges in every spanning tree.
+    [[nodiscard]] const Vector<Edge>& Edges() const { return edges; }     ///< Edges in the matrix order.
+    [[nodiscard]] bool IsBridge(size_t edge) const { return bridges[edge]; } ///< Checks an edge in the matrix order.
+
+    /// @brief Builds the graph of a weight vector.
+    /// @param weights One weight per edge in the matrix order, none of them 0.
+    /// @param order Receives the matrix index of every edge of the graph, by its index in the graph.
+    /// @return The graph, its edges sorted by their weights.
+    /// @throws std::runtime_error if the vector has a wrong length or a zero weight.
+    [[nodiscard]]
+    Graph Weigh(const Vector<int>& weights, Vector<int>& order) const;
+
+    /// @brief Builds the choices a search of a weighted graph starts with, the bridges included.
+    /// @param order The matrix index of every edge of the graph, as left by Weigh.
+    [[nodiscard]]
+    Partition::Choices InitialChoices(const Vector<int>& order) const;
+
+private:
+    size_t vertexCount;
+    Vector<Edge> edges;   ///< Edges in the matrix order, with the weights of the matrix.
+    Vector<char> bridges; ///< Per edge in the matrix order.
+    size_t bridgeCount = 0;
+};
+
+#endif // __TOPOLOGY_H
@@ -0,0 +1,115 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled{false};
+
+namespace {
+
+struct Span
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+/// Written by its thread only, read by Write.
+struct ThreadBuffer
+{
+    uint32_t tid;
+    const char* name = nullptr;
+    std::unique_ptr<Span[]> spans;
+    std::atomic<uint64_t> written{0}; ///< Spans ever recorded, the ring index is modulo capacity.
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry; ///< Outlives the threads.
+std::chrono::steady_clock::time_point startTime;
+size_t capacity = 0;
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+/// Registers the calling thread on its first span, the only locked step.
+ThreadBuffer& buffer()
+{
+    if (threadBuffer == nullptr) {
+        auto b = std::make_unique<ThreadBuffer>();
+        b->spans = std::make_unique<Span[]>(capacity);
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        b->tid = registry.size();
+        threadBuffer = b.get();
+        registry.push_back(std::move(b));
+    }
+    return *threadBuffer;
+}
+
+} // namespace
+
+void Tracer::Start(size_t eventsPerThread)
+{
+    capacity = eventsPerThread ? eventsPerThread : 1;
+    startTime = std::chrono::steady_clock::now();
+    enabled.store(true, std::memory_order_release);
+}
+
+uint64_t Tracer::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Tracer::Record(const char* name, uint64_t begin, uint64_t end)
+{
+    ThreadBuffer& b = buffer();
+    const uint64_t n = b.written.load(std::memory_order_relaxed);
+    b.spans[n % capacity] = Span{ name, begin, end };
+    b.written.store(n + 1, std::memory_order_release);
+}
+
+void Tracer::NameThread(const char* name)
+{
+    if (Enabled())
+        buffer().name = name;
+}
+
+bool Tracer::Write(const std::string& path)
+{
+    std::ofstream os(path);
+    os << std::fixed << std::setprecision(3);
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separate = [&] {
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& b : registry) {
+        if (b->name) {
+            separate();
+            os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+               << ",\"args\":{\"name\":\"" << b->name << "\"}}";
+        }
+
+        // Only the newest spans survive in a ring that went round.
+        const uint64_t written = b->written.load(std::memory_order_acquire);
+        const uint64_t oldest = written > capacity ? written - capacity : 0;
+
+        for (uint64_t i = oldest; i < written; ++i) {
+            const Span& s = b->spans[i % capacity];
+            separate();
+            os << "{\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid
+               << ",\"ts\":" << s.begin / 1e3 << ",\"dur\":" << (s.end - s.begin) / 1e3 << "}";
+        }
+    }
+
+    os << "\n]}\n";
+    return (bool)os;
+}
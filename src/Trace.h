@@ -0,0 +1,76 @@
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// @brief Records timed spans of every thread for the Chrome trace viewer.
+///
+/// Every thread writes its spans into its own ring buffer, allocated and
+/// registered the first time the thread records something. Recording is a
+/// store into the thread's buffer and a release store of its counter, no
+/// locks and no allocation. A full buffer overwrites its oldest spans.
+/// Write exports the spans in the Chrome trace event format, open it in
+/// chrome://tracing or https://ui.perfetto.dev.
+///
+/// Until Start is called nothing is recorded and a span costs a single
+/// relaxed load.
+class Tracer
+{
+public:
+    /// @brief Starts recording.
+    /// @param eventsPerThread Capacity of the ring buffer of every thread.
+    static void Start(size_t eventsPerThread = 1 << 18);
+
+    /// @brief Checks if spans are being recorded.
+    [[nodiscard]]
+    static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// @brief Retrieves the time since Start in nanoseconds.
+    [[nodiscard]]
+    static uint64_t Now();
+
+    /// @brief Records a span of the calling thread.
+    /// @param name Name of the span, must outlive the tracer (a literal).
+    /// @param begin Start of the span, from Now.
+    /// @param end End of the span, from Now.
+    static void Record(const char* name, uint64_t begin, uint64_t end);
+
+    /// @brief Names the calling thread in the exported trace.
+    static void NameThread(const char* name);
+
+    /// @brief Writes the recorded spans of all threads as a Chrome trace.
+    ///
+    /// The threads should be done recording, spans written meanwhile may be torn.
+    /// @return `false` if the file can't be written.
+    static bool Write(const std::string& path);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+/// @brief Records the lifetime of the scope as a span of the calling thread.
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+    : name(Tracer::Enabled() ? name : nullptr), begin(this->name ? Tracer::Now() : 0)
+    {}
+
+    ~TraceScope()
+    {
+        if (name)
+            Tracer::Record(name, begin, Tracer::Now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#endif // __TRACE_H
@@ -0,0 +1,193 @@
+#include "TreeVerifier.h"
+#include "DisjointSet.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <sstream>
+
+TreeVerifier::TreeVerifier(const Graph& g, size_t threadCount)
+: graph(g)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    maxQueued = 4 * threadCount;
+
+    for (size_t i = 0; i < threadCount; ++i)
+        workers.emplace_back(&TreeVerifier::work, this);
+}
+
+TreeVerifier::~TreeVerifier()
+{
+    if (!finished)
+        Finish();
+}
+
+void TreeVerifier::Submit(const Partition& p)
+{
+    pending.PushBack(Item{submitted++, p});
+
+    if (pending.Size() >= BATCH_SIZE)
+        flush();
+}
+
+void TreeVerifier::flush()
+{
+    if (pending.Empty())
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Don't let the producer run away from the workers.
+    notFull.wait(lock, [this] { return queue.size() < maxQueued; });
+
+    queue.push_back(std::move(pending));
+    pending = Vector<Item>();
+    notEmpty.notify_one();
+}
+
+TreeVerifier::Report TreeVerifier::Finish()
+{
+    if (finished)
+        return total;
+
+    flush();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    notEmpty.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+
+    finished = true;
+
+    std::ranges::sort(total.failures,
+        [](const auto& l, const auto& r) { return l.first < r.first; });
+
+    return total;
+}
+
+void TreeVerifier::work()
+{
+    Tracer::NameThread("verifier");
+
+    // Every worker owns its disjoint set and edge marks, nothing is shared while checking.
+    DisjointSet<int> ds(graph.VertexCount());
+    Vector<char> inTree(graph.EdgeCount(), 0);
+    Report local;
+
+    const Vector<Edge>& edges = graph.Edges();
+    const size_t treeEdgeCount = graph.VertexCount() - 1;
+
+    while (true)
+    {
+        Vector<Item> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] { return !queue.empty() || closing; });
+
+            if (queue.empty())
+                break;
+
+            batch = std::move(queue.front());
+            queue.pop_front();
+        }
+        notFull.notify_one();
+
+        TraceScope span("verify batch");
+
+        for (const Item& item : batch)
+        {
+            const Partition& k = item.tree;
+            local.checked++;
+
+            // Out of range indices would make the rest of the checks meaningless.
+            if (std::ranges::any_of(k.mstEdges,
+                    [&](const int e) { return e < 0 || (size_t)e >= edges.Size(); })) {
+                local.notSpanning++;
+                local.failures.emplace_back(item.index, "Bad-edge-index " + k.ToString());
+                continue;
+            }
+
+            // each edge addition should yield a new reachable vertex
+            // if its already included, then by adding this edge a cycle is introduced
+            ds.Reset();
+            bool cycle = false;
+            long long cost = 0;
+            for (const int ke : k.mstEdges)
+            {
+                const Edge& e = edges[ke];
+                cost += e.weight;
+                if (ds.NodesConnected(e.nodeX, e.nodeY))
+                    cycle = true;
+                ds.Unify(e.nodeX, e.nodeY);
+            }
+
+            if (cycle) {
+                local.nonTrees++;
+                local.failures.emplace_back(item.index, "Not-a-tree " + k.ToString());
+            } else if (k.mstEdges.Size() != treeEdgeCount || ds.numberOfComponents != 1) {
+                local.notSpanning++;
+                local.failures.emplace_back(item.index, "Not-spanning " + k.ToString());
+            }
+
+            if (cost != k.mstCost) {
+                local.costMismatches++;
+                std::stringstream ss;
+                ss << "Cost-mismatch (recomputed " << cost << ") " << k.ToString();
+                local.failures.emplace_back(item.index, ss.str());
+            }
+
+            // Trees read back from a file carry no choices, nothing to check then.
+            if (k.choices.Size() != edges.Size())
+                continue;
+
+            for (const int ke : k.mstEdges)
+                inTree[ke] = 1;
+
+            bool violated = false;
+            for (size_t i = 0; i < edges.Size(); ++i) {
+                if ((k.choices[i] == Partition::INCLUDED && !inTree[i]) ||
+                    (k.choices[i] == Partition::EXCLUDED && inTree[i]))
+                    violated = true;
+            }
+
+            for (const int ke : k.mstEdges)
+                inTree[ke] = 0;
+
+            if (violated) {
+                local.choiceViolations++;
+                local.failures.emplace_back(item.index, "Choice-violation " + k.ToString());
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    total.checked += local.checked;
+    total.nonTrees += local.nonTrees;
+    total.notSpanning += local.notSpanning;
+    total.costMismatches += local.costMismatches;
+    total.choiceViolations += local.choiceViolations;
+    for (auto& failure : local.failures)
+        total.failures.push_back(std::move(failure));
+}
+
+void TreeVerifier::PrintReport(std::ostream& os, const Report& report)
+{
+    for (const auto& [index, what] : report.failures)
+        os << "[" << index << "] " << what << "\n";
+
+    if (report.Ok()) {
+        os << "DONE: Found none (" << report.checked << " trees checked)\n";
+        return;
+    }
+
+    os << "DONE: Found "
+       << report.nonTrees << " non-trees, "
+       << report.notSpanning << " non-spanning, "
+       << report.costMismatches << " cost mismatches, "
+       << report.choiceViolations << " choice violations\n";
+}
@@ -0,0 +1,103 @@
+#ifndef __TREE_VERIFIER_H
+#define __TREE_VERIFIER_H
+
+#include "Graph.h"
+#include "Partition.h"
+#include "Vector.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// @brief Checks spanning trees for validity on a pool of worker threads.
+///
+/// Trees are submitted one by one (typically straight from the solver's
+/// callback), grouped into batches and verified by the workers, each using
+/// its own DisjointSet. For every tree it checks that it has |V|-1 edges,
+/// contains no cycle, spans the graph, that the recomputed cost equals
+/// `mstCost` and that it respects its own include/exclude choices.
+class TreeVerifier
+{
+public:
+    /// @brief Summary of a verification run.
+    struct Report
+    {
+        size_t checked = 0;          ///< Number of trees checked.
+        size_t nonTrees = 0;         ///< Trees containing a cycle.
+        size_t notSpanning = 0;      ///< Trees with a wrong edge count or more components.
+        size_t costMismatches = 0;   ///< Trees whose edges don't sum up to `mstCost`.
+        size_t choiceViolations = 0; ///< Trees breaking their include/exclude choices.
+
+        /// Failed trees as (tree index, description), ordered by the index.
+        std::vector<std::pair<size_t, std::string>> failures;
+
+        /// @brief Checks if no problem was found.
+        [[nodiscard]]
+        bool Ok() const { return failures.empty(); }
+    };
+
+    /// @brief Starts the workers.
+    /// @param g The graph the trees belong to.
+    /// @param threadCount Number of workers, 0 picks the hardware concurrency.
+    explicit TreeVerifier(const Graph& g, size_t threadCount = 0);
+
+    TreeVerifier(const TreeVerifier&) = delete;
+    TreeVerifier& operator=(const TreeVerifier&) = delete;
+
+    /// @brief Waits for the workers if Finish wasn't called.
+    ~TreeVerifier();
+
+    /// @brief Queues a tree for verification, trees are indexed in submission order.
+    ///
+    /// Only a single thread may submit. Blocks when the workers fall behind.
+    /// @param p The partition holding the tree.
+    void Submit(const Partition& p);
+
+    /// @brief Waits until all submitted trees are checked and stops the workers.
+    /// @return The summary of the run.
+    Report Finish();
+
+    /// @brief Prints the failures and the summary of a report.
+    /// @param os The output stream to write to.
+    /// @param report The report to print.
+    static void PrintReport(std::ostream& os, const Report& report);
+
+private:
+    /// A submitted tree together with its index.
+    struct Item
+    {
+        size_t index;
+        Partition tree;
+    };
+
+    static constexpr size_t BATCH_SIZE = 1024; ///< Trees handed to a worker at once.
+
+    const Graph& graph;
+    std::vector<std::thread> workers;
+
+    Vector<Item> pending;  ///< Batch being filled by the producer.
+    size_t submitted = 0;  ///< Number of submitted trees.
+    bool finished = false; ///< Finish was already called.
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<Vector<Item>> queue; ///< Batches waiting for a worker.
+    size_t maxQueued;               ///< Bound of the queue, keeps memory in check.
+    bool closing = false;           ///< No more batches will come.
+    Report total;                   ///< Merged results of the finished workers.
+
+    /// @brief Hands the pending batch over to the workers.
+    void flush();
+
+    /// @brief Worker loop, verifies batches until the queue is closed.
+    void work();
+};
+
+#endif // __TREE_VERIFIER_H
@@ -131,7 +131,7 @@ public:
 
     void Insert(size_t index, const T& value) {
         if (index >= _capacity) {
-            Resize(_capacity << 1); // double the size
+            Resize(_capacity ? _capacity << 1 : 2); // double the size
         }
 
         _block[index] = value;
@@ -143,14 +143,14 @@ public:
 
     void PushBack(const T& value) {
         if (_size >= _capacity) {
-            Resize(_capacity * 2);
+            Resize(_capacity ? _capacity * 2 : 2);
         }
         new(&_block[_size++]) T(value); 
     }
 
     void PushBack(T&& value) {
         if (_size >= _capacity) {
-            Resize(_capacity * 2);
+            Resize(_capacity ? _capacity * 2 : 2);
         }
         new(&_block[_size++]) T(std::move(value));
     }
@@ -158,7 +158,7 @@ public:
     template <typename ...Args>
     T& EmplaceBack(Args&&... args) {
         if (_size >= _capacity) {
-            Resize(_capacity * 2); // double the size
+            Resize(_capacity ? _capacity * 2 : 2); // double the size
         }
         // _block[_size] = T(std::forward<Args>(args)...);
         new(&_block[_size]) T(std::forward<Args>(args)...);
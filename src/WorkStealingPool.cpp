@@ -0,0 +1,61 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    /// Jobs waiting for a worker, the owner takes from the back, thieves from the front.
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<size_t> items;
+    };
+}
+
+size_t WorkStealingPool::Threads(const size_t requested, const size_t jobs)
+{
+    const size_t threads = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+    return std::max<size_t>(std::min(threads, jobs), 1);
+}
+
+void WorkStealingPool::Run(const size_t jobs, const size_t threads, const Job& work)
+{
+    std::vector<WorkQueue> queues(threads);
+    for (size_t i = 0; i < jobs; ++i)
+        queues[i % threads].items.push_back(i);
+
+    auto take = [&queues](const size_t self, size_t& job) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            WorkQueue& queue = queues[(self + i) % queues.size()];
+            std::lock_guard guard(queue.lock);
+            if (queue.items.empty())
+                continue;
+            if (i == 0) {
+                job = queue.items.back();
+                queue.items.pop_back();
+            } else {
+                job = queue.items.front();
+                queue.items.pop_front();
+            }
+            return true;
+        }
+        return false;
+    };
+
+    // Nothing new is queued while running, all queues empty means done.
+    auto worker = [&](const size_t self) {
+        for (size_t job; take(self, job); )
+            work(self, job);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(worker, i);
+    worker(0);
+    for (std::thread& w : workers)
+        w.join();
+}
@@ -0,0 +1,34 @@
+#ifndef __WORK_STEALING_POOL_H
+#define __WORK_STEALING_POOL_H
+
+#include <cstddef>
+#include <functional>
+
+/// @brief Runs independent jobs on a pool of threads that steal from each other.
+///
+/// The jobs are dealt out to the workers up front, each worker takes from
+/// the back of its own queue and, once that runs dry, steals from the front
+/// of the others. Workers are numbered, so whatever a worker keeps from one
+/// job to the next can be held in a vector indexed by its number. The
+/// calling thread is worker 0.
+class WorkStealingPool
+{
+public:
+    /// @brief Receives a job, `worker` is below the thread count of the run.
+    using Job = std::function<void(size_t worker, size_t job)>;
+
+    /// @brief Picks the number of workers.
+    /// @param requested Workers asked for, 0 picks the hardware concurrency.
+    /// @param jobs Number of jobs, there are never more workers than jobs.
+    /// @return The number of workers, at least 1.
+    [[nodiscard]]
+    static size_t Threads(size_t requested, size_t jobs);
+
+    /// @brief Runs jobs 0 to `jobs`-1 and waits for all of them.
+    /// @param jobs Number of jobs.
+    /// @param threads Number of workers, see Threads.
+    /// @param work Runs one job, it must not throw.
+    static void Run(size_t jobs, size_t threads, const Job& work);
+};
+
+#endif // __WORK_STEALING_POOL_H
@@ -1,72 +1,824 @@
 #include "Partition.h"
 #include "Graph.h"
+#include "Benchmark.h"
+#include "BatchSolver.h"
+#include "BlockSolver.h"
+#include "Daemon.h"
+#include "GraphGenerator.h"
+#include "MicroBenchmark.h"
+#include "PerfCounters.h"
+#include "ResultCache.h"
+#include "Trace.h"
+#include "MatrixParser.h"
 #include "SpanningTreesFinder.h"
+#include "DeltaEncoding.h"
+#include "DuplicateDetector.h"
+#include "OutputBuffer.h"
+#include "ResultFile.h"
+#include "TreeVerifier.h"
 #include "Vector.h"
 
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <ostream>
+#include <vector>
+
+/// Set by SIGINT/SIGTERM, stops the search after writing a checkpoint.
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+static void printUsage() {
+    using std::cout;
+    cout << "Usage:\n";
+    cout << "    kthmst <input_file> <print_type> [options]\n";
+    cout << "        input_file        adjacent matrix\n";
+    cout << "        print_type        0 - nothing\n";
+    cout << "                          1 - only kth\n";
+    cout << "                          2 - all\n";
+    cout << "                          3 - all, one line per tree\n";
+    cout << "    options:\n";
+    cout << "        --save <file>     store the trees in a binary result file\n";
+    cout << "        --save-text <file>\n";
+    cout << "                          store the trees in a text result file\n";
+    cout << "        --save-delta <file>\n";
+    cout << "                          store the trees as edge swaps against earlier trees\n";
+    cout << "        --memory-limit <MB>\n";
+    cout << "                          spill unexpanded partitions to disk above this size\n";
+    cout << "        --spill-dir <dir> directory of the spilled partitions\n";
+    cout << "        --max-partitions <n>\n";
+    cout << "                          drop partitions over this count, rebuild them when needed\n";
+    cout << "        --checkpoint <file>\n";
+    cout << "                          periodically save the state of the search\n";
+    cout << "        --checkpoint-interval <s>\n";
+    cout << "                          seconds between two checkpoints (default 60)\n";
+    cout << "        --resume <file>   continue the search saved in a checkpoint\n";
+    cout << "        --trees <k>       enumerate only the first k trees\n";
+    cout << "        --cache <dir>     take the trees from a cache of earlier runs, store new ones there\n";
+    cout << "        --cache-size <MB> size the cache is kept under (default 1024)\n";
+    cout << "        --blocks          search the biconnected blocks apart, merge their trees\n";
+    cout << "        --kernel <k>      how the tree of a search space is found: auto (default),\n";
+    cout << "                          kruskal or prim, the trees are the same\n";
+    cout << "        --stats <file>    store the counters of the search as JSON\n";
+    cout << "        --progress        print a progress line to stderr every second\n";
+    cout << "        --trace <file>    record a timeline of the phases and threads (Chrome trace)\n";
+    cout << "        --perf            count cache, branch and TLB misses per phase into --stats\n";
+    cout << "\n";
+    cout << "    kthmst verify <input_file> <result_file>\n";
+    cout << "        checks the trees stored in a result file against the graph\n";
+    cout << "\n";
+    cout << "    kthmst read <result_file> [tree <i> | cost <c>]\n";
+    cout << "        prints the i-th tree or all trees of cost c of a binary result file\n";
+    cout << "\n";
+    cout << "    kthmst decode <delta_file>\n";
+    cout << "        prints the trees of a delta file in the text result format\n";
+    cout << "\n";
+    cout << "    kthmst bench [--seed <s>] [--trees <k>] [--family <f> --size <n>]\n";
+    cout << "                 [--memory-limit <MB>] [--max-partitions <n>] [--perf]\n";
+    cout << "        enumerates the first k trees (default 10000) of generated graphs,\n";
+    cout << "        prints the measurements as JSON\n";
+    cout << "\n";
+    cout << "    kthmst microbench [--warmup <n>] [--reps <n>] [--filter <text>] [--json]\n";
+    cout << "        compares the containers with the standard ones\n";
+    cout << "\n";
+    cout << "    kthmst batch <dir|list> [--threads <n>] [--trees <k>] [--output <file>]\n";
+    cout << "                 [--memory-limit <MB>] [--max-partitions <n>]\n";
+    cout << "        solves the .in files of a directory (or the files of a list) on a pool\n";
+    cout << "        of threads, writes the trees of all of them into one text stream\n";
+    cout << "\n";
+    cout << "    kthmst scenarios <topology_file> <weights_file> [--threads <n>] [--trees <k>]\n";
+    cout << "                     [--output <file>] [--memory-limit <MB>] [--max-partitions <n>]\n";
+    cout << "        solves the graph of the adjacency matrix under every weight vector of\n";
+    cout << "        the weights file, one vector per line listing the edges in the order of\n";
+    cout << "        the matrix, row by row; the trees list the edges in the same order\n";
+    cout << "\n";
+    cout << "    kthmst daemon [--socket <path>] [--memory-limit <MB>] [--spill-dir <dir>]\n";
+    cout << "                  [--max-partitions <n>]\n";
+    cout << "        answers tree queries on stdin (or the socket), keeping the searches\n";
+    cout << "        warm, see Daemon.h for the requests\n";
+    cout << "\n";
+    cout << "    kthmst generate <family> <size> [seed]\n";
+    cout << "        prints a generated graph in the input format, families are\n";
+    cout << "        complete, grid, sparse, equal-weights and near-tree\n";
+}
+
+/// Checks the trees of a stored result file,
+/// streaming them through the verifier.
+static int verify(const char* inputPath, const char* resultPath) {
+    using std::cout;
+
+    Graph graph;
+    try {
+        graph = SpanningTreesFinder::ReadGraph(std::string(inputPath));
+    } catch (const std::runtime_error& e) {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+
+    TreeVerifier verifier(graph);
+    DuplicateDetector duplicates(graph.EdgeCount());
+    size_t dupCount = 0;
+
+    // The verifier reports out of range edges, the detector would index with them.
+    auto check = [&](const Partition& tree) {
+        const bool inRange = std::ranges::all_of(tree.mstEdges,
+            [&](const int e) { return e >= 0 && (size_t)e < graph.EdgeCount(); });
+        if (inRange && !duplicates.Insert(tree))
+            cout << "Found-duplicate (" << ++dupCount << ")\n" << tree << "\n";
+        verifier.Submit(tree);
+    };
+
+    if (ResultFileReader::IsResultFile(resultPath)) {
+        const ResultFileReader result(resultPath);
+
+        if (result.GraphHash() != graph.Hash()) {
+            cout << "ERROR: The result file belongs to a different graph...\n";
+            return 1;
+        }
+
+        cout << "INFO: Verifying trees...\n";
+        for (size_t i = 0; i < result.TreeCount(); ++i)
+            check(result.Tree(i));
+    } else {
+        std::ifstream result(resultPath);
+        size_t vertexCount = 0, edgeCount = 0;
+        if (!SpanningTreesFinder::ReadResultHeader(result, vertexCount, edgeCount)) {
+            cout << "ERROR: '" << resultPath << "' is not a result file...\n";
+            return 1;
+        }
+
+        if (vertexCount != graph.VertexCount() || edgeCount != graph.EdgeCount()) {
+            cout << "ERROR: The result file belongs to a different graph...\n";
+            return 1;
+        }
+
+        cout << "INFO: Verifying trees...\n";
+        Partition tree(graph.VertexCount());
+        while (SpanningTreesFinder::ReadResultLine(result, tree))
+            check(tree);
+    }
+
+    const TreeVerifier::Report report = verifier.Finish();
+    TreeVerifier::PrintReport(cout, report);
+    cout << "DONE: Found " << dupCount << " dups\n";
+
+    return report.Ok() && dupCount == 0 ? 0 : 1;
+}
+
+/// Looks trees up in a binary result file
+/// without solving or parsing anything.
+static int read(const int argc, const char** argv) {
+    using std::cout;
+
+    const ResultFileReader result(argv[2]);
+
+    if (argc == 3) {
+        cout << "|V| = " << result.VertexCount()
+             << ", |E| = " << result.EdgeCount()
+             << ", trees = " << result.TreeCount()
+             << ", graph hash = " << std::hex << result.GraphHash() << std::dec << "\n";
+        return 0;
+    }
+
+    OutputBuffer out(stdout);
+
+    if (argc == 5 && !strcmp(argv[3], "tree")) {
+        SpanningTreesFinder::WriteResultLine(out, result.Tree(strtoull(argv[4], nullptr, 10)));
+        return 0;
+    }
+
+    if (argc == 5 && !strcmp(argv[3], "cost")) {
+        const auto [first, last] = result.TreesAtCost(atoi(argv[4]));
+        for (size_t i = first; i < last; ++i) {
+            out << '[' << i << "] ";
+            SpanningTreesFinder::WriteResultLine(out, result.Tree(i));
+        }
+        return 0;
+    }
+
+    printUsage();
+    return 0;
+}
+
+/// Expands a delta file back into
+/// the text result format.
+static int decode(const char* deltaPath) {
+    std::ifstream input(deltaPath);
+    DeltaReader reader(input);
+    OutputBuffer out(stdout);
+
+    SpanningTreesFinder::WriteResultHeader(out, reader.VertexCount(), reader.EdgeCount());
+
+    Partition tree(reader.VertexCount());
+    while (reader.Next(tree))
+        SpanningTreesFinder::WriteResultLine(out, tree);
+
+    return 0;
+}
+
+/// Runs the benchmark suite, or a single case,
+/// and prints the results as JSON.
+static int bench(const int argc, const char** argv) {
+    uint64_t seed = 1;
+    size_t k = 10000;
+    size_t size = 0;
+    const char* familyName = nullptr;
+    bool countPerf = false;
+    SolveOptions options;
+
+    for (int i = 2; i < argc; ++i) {
+        if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--trees") && i + 1 < argc) {
+            k = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--family") && i + 1 < argc) {
+            familyName = argv[++i];
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            size = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--memory-limit") && i + 1 < argc) {
+            options.memoryLimit = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (!strcmp(argv[i], "--max-partitions") && i + 1 < argc) {
+            options.partitionLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--perf")) {
+            countPerf = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<Benchmark::Case> cases;
+    if (familyName) {
+        GraphGenerator::Family family;
+        if (!GraphGenerator::ParseFamily(familyName, family) || size == 0) {
+            std::cerr << "ERROR: A single case needs a known --family and a --size...\n";
+            return 1;
+        }
+        cases.push_back({ family, size, seed, k });
+    } else {
+        cases = Benchmark::DefaultSuite(seed, k);
+    }
+
+    std::vector<Benchmark::Result> results;
+    for (const Benchmark::Case& c : cases) {
+        std::cerr << "INFO: Running " << GraphGenerator::FamilyName(c.family) << " " << c.size << "...\n";
+        results.push_back(Benchmark::Run(c, options, countPerf));
+    }
+
+    Benchmark::WriteJson(std::cout, results);
+    return 0;
+}
+
+/// Runs the container microbenchmarks.
+static int microbench(const int argc, const char** argv) {
+    MicroBenchmark::Options options;
+    bool json = false;
+
+    for (int i = 2; i < argc; ++i) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < argc) {
+            options.warmup = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--reps") && i + 1 < argc) {
+            options.repetitions = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (!strcmp(argv[i], "--json")) {
+            json = true;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const std::vector<MicroBenchmark::Result> results = MicroBenchmark::RunAll(options);
+    if (json)
+        MicroBenchmark::WriteJson(std::cout, results);
+    else
+        MicroBenchmark::Print(std::cout, results);
+    return 0;
+}
+
+/// Solves a whole directory of graphs in one process,
+/// or one topology under many weight vectors.
+static int batch(const int argc, const char** argv) {
+    const bool scenarios = !strcmp(argv[1], "scenarios");
+    BatchSolver::Options options;
+    const char* outputPath = nullptr;
+
+    for (int i = scenarios ? 4 : 3; i < argc; ++i) {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            options.threads = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--trees") && i + 1 < argc) {
+            options.solve.treeLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (!strcmp(argv[i], "--memory-limit") && i + 1 < argc) {
+            options.solve.memoryLimit = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (!strcmp(argv[i], "--max-partitions") && i + 1 < argc) {
+            options.solve.partitionLimit = strtoull(argv[++i], nullptr, 10);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<std::string> paths;
+    std::unique_ptr<Topology> topology;
+    std::vector<Vector<int>> weights;
+
+    if (scenarios) {
+        topology = std::make_unique<Topology>(MatrixParser::ReadEdges(argv[2]));
+
+        std::ifstream weightsInput(argv[3]);
+        if (!weightsInput) {
+            std::cerr << "ERROR: Cannot read '" << argv[3] << "'...\n";
+            return 1;
+        }
+        weights = BatchSolver::ReadScenarios(weightsInput);
+
+        std::cerr << "INFO: |V| = " << topology->VertexCount() << ", |E| = " << topology->EdgeCount()
+                  << ", " << topology->BridgeCount() << " bridges, " << weights.size() << " scenarios\n";
+    } else {
+        paths = BatchSolver::ListInputs(argv[2]);
+    }
+
+    FILE* output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!output) {
+        std::cerr << "ERROR: Cannot create '" << outputPath << "'...\n";
+        return 1;
+    }
+
+    const BatchSolver::Summary summary = scenarios
+        ? BatchSolver::RunScenarios(*topology, weights, output, options)
+        : BatchSolver::Run(paths, output, options);
+    if (outputPath)
+        fclose(output);
+
+    const char* unit = scenarios ? "scenarios" : "graphs";
+    std::cerr << "DONE: " << summary.graphs << " " << unit << " solved, " << summary.failed << " failed, "
+              << summary.trees << " trees in " << summary.seconds << " s on " << summary.threads
+              << " threads (" << (summary.graphs + summary.failed) / summary.seconds << " " << unit << "/s)\n";
+    return summary.failed == 0 ? 0 : 1;
+}
+
+/// Serves tree queries until told to quit,
+/// on stdin/stdout or on a Unix socket.
+static int serve(const int argc, const char** argv) {
+    const char* socketPath = nullptr;
+    SolveOptions options;
+
+    for (int i = 2; i < argc; ++i) {
+        if (!strcmp(argv[i], "--socket") && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (!strcmp(argv[i], "--memory-limit") && i + 1 < argc) {
+            options.memoryLimit = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (!strcmp(argv[i], "--spill-dir") && i + 1 < argc) {
+            options.spillDirectory = argv[++i];
+        } else if (!strcmp(argv[i], "--max-partitions") && i + 1 < argc) {
+            options.partitionLimit = strtoull(argv[++i], nullptr, 10);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Daemon server(options);
+    if (socketPath) {
+        std::cerr << "INFO: Listening on " << socketPath << "...\n";
+        server.Listen(socketPath);
+    } else {
+        server.Serve(stdin, stdout);
+    }
+    return 0;
+}
 
 int main(const int argc, const char** argv) {
     using std::cout;
 
+    if (argc == 4 && !strcmp(argv[1], "verify")) {
+        try {
+            return verify(argv[2], argv[3]);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (argc >= 3 && !strcmp(argv[1], "read")) {
+        try {
+            return read(argc, argv);
+        } catch (const std::exception& e) {
+            cout << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "bench")) {
+        try {
+            return bench(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if ((argc >= 3 && !strcmp(argv[1], "batch")) || (argc >= 4 && !strcmp(argv[1], "scenarios"))) {
+        try {
+            return batch(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "daemon")) {
+        try {
+            return serve(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (argc >= 2 && !strcmp(argv[1], "microbench"))
+        return microbench(argc, argv);
+
+    if ((argc == 4 || argc == 5) && !strcmp(argv[1], "generate")) {
+        GraphGenerator::Family family;
+        if (!GraphGenerator::ParseFamily(argv[2], family)) {
+            std::cerr << "ERROR: Unknown graph family '" << argv[2] << "'...\n";
+            return 1;
+        }
+        const uint64_t seed = argc == 5 ? strtoull(argv[4], nullptr, 10) : 1;
+        try {
+            GraphGenerator::Write(cout, GraphGenerator::Generate(family, strtoull(argv[3], nullptr, 10), seed));
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc == 3 && !strcmp(argv[1], "decode")) {
+        try {
+            return decode(argv[2]);
+        } catch (const std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
     // Simple command line argument checker.
-    if (argc != 3) {
-        cout << "Usage:\n";
-        cout << "    kthmst <input_file> <print_bool>\n";
-        cout << "        input_file        adjacent matrix\n";
-        cout << "        print_type        0 - nothing\n";
-        cout << "                          1 - only kth\n";
-        cout << "                          2 - all\n";
+    if (argc < 3) {
+        printUsage();
         return 0;
     }
 
-    // Read in the adjacencyMatrix from the input file
-    // and put it into a Matrix.
-    std::ifstream input(argv[1]);
-    Matrix<int> adjMat = SpanningTreesFinder::ReadAdjacencyMatrix(input);
+    const char* savePath = nullptr;
+    const char* saveTextPath = nullptr;
+    const char* saveDeltaPath = nullptr;
+    const char* statsPath = nullptr;
+    const char* tracePath = nullptr;
+    const char* cacheDirectory = nullptr;
+    size_t cacheSize = size_t(1024) << 20;
+    bool progress = false;
+    bool blocks = false;
+    std::unique_ptr<PerfCounters> perf;
+    SolveOptions options;
+    for (int i = 3; i < argc; ++i) {
+        if (!strcmp(argv[i], "--save") && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (!strcmp(argv[i], "--save-text") && i + 1 < argc) {
+            saveTextPath = argv[++i];
+        } else if (!strcmp(argv[i], "--save-delta") && i + 1 < argc) {
+            saveDeltaPath = argv[++i];
+        } else if (!strcmp(argv[i], "--memory-limit") && i + 1 < argc) {
+            options.memoryLimit = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (!strcmp(argv[i], "--spill-dir") && i + 1 < argc) {
+            options.spillDirectory = argv[++i];
+        } else if (!strcmp(argv[i], "--max-partitions") && i + 1 < argc) {
+            options.partitionLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--checkpoint") && i + 1 < argc) {
+            options.checkpointPath = argv[++i];
+        } else if (!strcmp(argv[i], "--checkpoint-interval") && i + 1 < argc) {
+            options.checkpointInterval = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--resume") && i + 1 < argc) {
+            options.resumePath = argv[++i];
+        } else if (!strcmp(argv[i], "--stats") && i + 1 < argc) {
+            statsPath = argv[++i];
+        } else if (!strcmp(argv[i], "--progress")) {
+            progress = true;
+        } else if (!strcmp(argv[i], "--perf")) {
+            perf = std::make_unique<PerfCounters>();
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (!strcmp(argv[i], "--trees") && i + 1 < argc) {
+            options.treeLimit = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--cache") && i + 1 < argc) {
+            cacheDirectory = argv[++i];
+        } else if (!strcmp(argv[i], "--cache-size") && i + 1 < argc) {
+            cacheSize = strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (!strcmp(argv[i], "--blocks")) {
+            blocks = true;
+        } else if (!strcmp(argv[i], "--kernel") && i + 1 < argc) {
+            const char* kernel = argv[++i];
+            if (!strcmp(kernel, "auto")) {
+                options.kernel = SolveOptions::AUTO;
+            } else if (!strcmp(kernel, "kruskal")) {
+                options.kernel = SolveOptions::KRUSKAL;
+            } else if (!strcmp(kernel, "prim")) {
+                options.kernel = SolveOptions::PRIM;
+            } else {
+                printUsage();
+                return 1;
+            }
+        } else {
+            printUsage();
+            return 0;
+        }
+    }
+
+    // Based on the inputted flag
+    // vary the verbosity of debug printing.
+    const int mode = atoi(argv[2]);
+
+    // With the compact listing, stdout carries only the trees.
+    std::ostream& log = mode == 3 ? std::cerr : std::cout;
+
+    // A resumed search keeps saving into the checkpoint it came from.
+    if (!options.resumePath.empty() && options.checkpointPath.empty())
+        options.checkpointPath = options.resumePath;
+
+    // The delta references would point at trees of the previous run.
+    if (!options.resumePath.empty() && saveDeltaPath) {
+        log << "ERROR: --save-delta can't be combined with --resume...\n";
+        return 1;
+    }
+
+    // The cache keeps its own checkpoints.
+    if (cacheDirectory && !options.checkpointPath.empty()) {
+        log << "ERROR: --cache can't be combined with --checkpoint or --resume...\n";
+        return 1;
+    }
 
-    // Construct a graph out of the adjacency matrix.
-    // Debug print out. 
-    Graph graph(adjMat);
-    cout << graph.ToString();
+    // The block searches have no single frontier to save or cache.
+    if (blocks && (cacheDirectory || !options.checkpointPath.empty())) {
+        log << "ERROR: --blocks can't be combined with --cache, --checkpoint or --resume...\n";
+        return 1;
+    }
+
+#ifdef KTHMST_NO_STATS
+    // The counters are compiled out, there'd be nothing but zeros to show.
+    if (statsPath || progress) {
+        log << "ERROR: --stats and --progress aren't available in a build without counters (make STATS=0)...\n";
+        return 1;
+    }
+#endif
+
+    // Interrupting a checkpointed search saves it instead of losing it.
+    if (!options.checkpointPath.empty()) {
+        options.stop = &stopRequested;
+        signal(SIGINT, requestStop);
+        signal(SIGTERM, requestStop);
+    }
+
+    if (perf && !perf->Available())
+        log << "INFO: Hardware counters unavailable, " << perf->Report().reason << "\n";
+    options.perf = perf.get();
+
+    if (tracePath) {
+        Tracer::Start();
+        Tracer::NameThread("main");
+    }
+
+    // Read the graph out of the adjacency matrix in the input file,
+    // its edges are taken while parsing, the matrix is never held.
+    // Parsing is charged to PARSE, sorting the edges to GRAPH_BUILD.
+    // Debug print out.
+    MatrixParser::EdgeList edges;
+    try {
+        edges = MatrixParser::ReadEdges(std::string(argv[1]));
+    } catch (const std::runtime_error& e) {
+        log << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    PerfScope graphBuild(perf.get(), PerfReport::GRAPH_BUILD);
+    const uint64_t graphBegin = Tracer::Enabled() ? Tracer::Now() : 0;
+    const Graph graph = MatrixParser::BuildGraph(std::move(edges));
+    if (Tracer::Enabled())
+        Tracer::Record("graph", graphBegin, Tracer::Now());
+    log << graph.ToString();
 
-    // Check if it's a null graph. 
+    // Check if it's a null graph.
     // If so, no point in solving it.
     if (!graph.VertexCount() || !graph.EdgeCount()) {
-        cout << "ERROR: Cannot solve for a tree with no vertices or edges...\n";
+        log << "ERROR: Cannot solve for a tree with no vertices or edges...\n";
         return 0;
     }
 
-    // Retrieve all the possible spanning trees 
-    // and put it into a list.
-    Vector<Partition> trees = SpanningTreesFinder::Solve(graph);
+    PerfScope output(perf.get(), PerfReport::OUTPUT);
 
-    // Based on the inputted flag
-    // vary the verbosity of debug printing.
-    int mode = atoi(argv[2]);
-    SpanningTreesFinder::PrintTrees(trees, graph, mode);
+    std::unique_ptr<ResultFileWriter> save;
+    if (savePath) {
+        try {
+            save = std::make_unique<ResultFileWriter>(savePath, graph);
+        } catch (const std::runtime_error&) {
+            log << "ERROR: Cannot create '" << savePath << "'...\n";
+            return 1;
+        }
+    }
+
+    // The trees of the HTML page are appended to its sidecar as they are found.
+    std::unique_ptr<ResultFileWriter> html;
+    const std::string htmlDataPath = SpanningTreesFinder::HtmlDataPath("treeees.html");
+    try {
+        html = std::make_unique<ResultFileWriter>(htmlDataPath.c_str(), graph);
+    } catch (const std::runtime_error&) {
+        log << "ERROR: Cannot create '" << htmlDataPath << "'...\n";
+        return 1;
+    }
+
+    FILE* saveTextFile = nullptr;
+    std::unique_ptr<OutputBuffer> saveText;
+    if (saveTextPath) {
+        saveTextFile = fopen(saveTextPath, "w");
+        if (!saveTextFile) {
+            log << "ERROR: Cannot create '" << saveTextPath << "'...\n";
+            return 1;
+        }
+        saveText = std::make_unique<OutputBuffer>(saveTextFile);
+        SpanningTreesFinder::WriteResultHeader(*saveText, graph);
+    }
+
+    FILE* saveDeltaFile = nullptr;
+    std::unique_ptr<OutputBuffer> saveDeltaBuffer;
+    std::unique_ptr<DeltaWriter> saveDelta;
+    if (saveDeltaPath) {
+        saveDeltaFile = fopen(saveDeltaPath, "w");
+        if (!saveDeltaFile) {
+            log << "ERROR: Cannot create '" << saveDeltaPath << "'...\n";
+            return 1;
+        }
+        saveDeltaBuffer = std::make_unique<OutputBuffer>(saveDeltaFile);
+        saveDelta = std::make_unique<DeltaWriter>(*saveDeltaBuffer, graph);
+    }
+
+    // Every tree is checked for cycles, spanning and its cost
+    // by the verifier's workers and for duplicates as soon as it's found.
+    // The list of all the trees is kept only for printing them.
+    TreeVerifier verifier(graph);
+    DuplicateDetector duplicates(graph.EdgeCount());
+    Vector<Partition> duplicateTrees;
+    const bool keepTrees = mode == 1 || mode == 2 || mode == 3;
+    Vector<Partition> trees;
+
+    if (!options.resumePath.empty())
+        log << "INFO: Resuming from '" << options.resumePath << "'...\n";
+
+    SolveStats stats;
+    if (statsPath || progress)
+        options.stats = &stats;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto lastProgress = start;
+    size_t found = 0;
+    int firstCost = 0, lastCost = 0;
+
+    try {
+        std::unique_ptr<ResultCache> cache;
+        if (cacheDirectory)
+            cache = std::make_unique<ResultCache>(cacheDirectory, cacheSize);
+
+        const SpanningTreesFinder::TreeCallback onTree = [&](const Partition& tree) {
+            {
+                PerfScope validation(perf.get(), PerfReport::VALIDATION);
+                verifier.Submit(tree);
+                if (!duplicates.Insert(tree))
+                    duplicateTrees.PushBack(tree);
+            }
+
+            PerfScope output(perf.get(), PerfReport::OUTPUT);
+            if (save)
+                save->Append(tree);
+            if (saveText)
+                SpanningTreesFinder::WriteResultLine(*saveText, tree);
+            if (saveDelta)
+                saveDelta->Append(tree);
+            // The page shows the first tree of every cost level, all of them in mode 2.
+            if (mode == 2 || ((mode == 0 || mode == 1) && (found == 0 || lastCost < tree.mstCost)))
+                html->Append(tree);
+            if (keepTrees)
+                trees.PushBack(tree);
+
+            if (found++ == 0)
+                firstCost = tree.mstCost;
+            lastCost = tree.mstCost;
+
+            // Looking at the clock only now and then keeps it off the hot path.
+            if (progress && found % 256 == 0 && Clock::now() - lastProgress >= std::chrono::seconds(1)) {
+                lastProgress = Clock::now();
+                const double seconds = std::chrono::duration<double>(lastProgress - start).count();
+                std::cerr << "INFO: " << found << " trees, cost " << tree.mstCost
+                          << ", frontier " << stats.frontierSize << " (high " << stats.frontierHighWater << "), "
+                          << (size_t)(found / seconds) << " trees/s\n";
+            }
+            return true;
+        };
+
+        if (cache) {
+            const size_t cached = cache->Solve(graph, onTree, options);
+            log << "INFO: " << cached << " trees taken from the cache\n";
+        } else if (blocks) {
+            BlockSolver solver(graph);
+            log << "INFO: " << solver.BlockCount() << " blocks (largest " << solver.LargestBlock()
+                << " edges), " << solver.BridgeCount() << " bridges\n";
+            solver.Solve(onTree, options);
+        } else {
+            SpanningTreesFinder::Solve(graph, onTree, options);
+        }
+    } catch (const std::runtime_error& e) {
+        log << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+
+    const double solveSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (stopRequested)
+        log << "INFO: Interrupted, the search is saved in '" << options.checkpointPath << "'\n";
+
+    if (save) {
+        try {
+            save->Close();
+        } catch (const std::runtime_error&) {
+            log << "ERROR: Cannot write '" << savePath << "'...\n";
+            return 1;
+        }
+    }
+
+    if (saveText) {
+        saveText.reset();
+        fclose(saveTextFile);
+    }
+
+    if (saveDelta) {
+        saveDelta.reset();
+        saveDeltaBuffer.reset();
+        fclose(saveDeltaFile);
+    }
+
+    if (keepTrees)
+        SpanningTreesFinder::PrintTrees(trees, graph, mode);
+    else
+        SpanningTreesFinder::PrintSummary(log, found, firstCost, lastCost);
 
-    // If there are any non-trees among the supposed spanning trees, 
-    // find them and print them out.
-    SpanningTreesFinder::TestCycles(trees, graph);
+    {
+        PerfScope validation(perf.get(), PerfReport::VALIDATION);
+        TraceScope span("validate");
 
-    // If there are any duplicate trees, 
-    // find them and print them out.
-    SpanningTreesFinder::TestDuplicates(trees);
+        // If there are any non-trees among the supposed spanning trees,
+        // find them and print them out.
+        log << "INFO: Testing for cycles...\n";
+        TreeVerifier::PrintReport(log, verifier.Finish());
+
+        // If there are any duplicate trees, print them out.
+        SpanningTreesFinder::ReportDuplicates(duplicateTrees, log);
+    }
 
     // Construct HTML document out of the found spanning trees.
     // Open in browser: `firefox ./treeees.html`
+    try {
+        html->Close();
+    } catch (const std::runtime_error&) {
+        log << "ERROR: Cannot write '" << htmlDataPath << "'...\n";
+        return 1;
+    }
     SpanningTreesFinder::WriteToHtml(
         "treeees.html",
         "./html-builder/head.html",
         "./html-builder/tail.html",
-        mode, graph, trees
+        graph
     );
 
-    return 0;
-}
-
+    if (tracePath && !Tracer::Write(tracePath))
+        log << "ERROR: Cannot write '" << tracePath << "'...\n";
 
+    if (statsPath) {
+        std::ofstream statsFile(statsPath);
+        const PerfReport perfReport = perf ? perf->Report() : PerfReport();
+        stats.WriteJson(statsFile, solveSeconds, perf ? &perfReport : nullptr);
+        if (!statsFile)
+            log << "ERROR: Cannot write '" << statsPath << "'...\n";
+    }
 
+    return 0;
+}